@@ -3,6 +3,9 @@
 #include <string>
 #include <filesystem>
 #include <set>
+#include <unordered_map>
+#include <memory>
+#include <deque>
 #include <functional>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -14,13 +17,46 @@
 #define IMAGE_CHANNELS 4 //rgba, just to avoid magic numbers
 #define VERT_SIZE (4 * sizeof(float) + 2 * sizeof(unsigned int))
 #define BUFFER_SIZE (VERT_SIZE * 3 * 1000000) //68.6 Mbs, up to a million triangles
+#define GLYPH_INSTANCE_SIZE (4 * sizeof(float) + 2 * sizeof(unsigned int)) //position, scale, texture index, modulate color
+
+#define SHADER_FEATURE_TEXTURES 1 //layer draws textured primitives, layers without it are drawn by a color only program
+#define SHADER_FEATURE_TILING 2 //layer's texture coordinates go outside of [0, 1], textures are then repeated per fragment instead of being mapped per vertex
+
+#define PIXEL_BUFFER_COUNT 3 //size of the pixel buffer ring used for streaming textures, see 'LoadTextureAsync'
 
 #define IMAGE_EXTS { ".png", ".jpeg", ".bmp" }
+#define FONT_CACHE_EXT ".fontcache" //appended to font's path, see 'LoadBdfFont'
+#define SHADER_CACHE_EXT ".shadercache" //extension of program binaries in 'ShaderCacheDirectory', see 'GetShader'
 
 #define HEIGHT_MAX 0xFFFFFFFF
 #define HEIGHT_MIN 0
 
 #define SSBO_BINDING 1
+#define TEXTURE_INDEX_BITS 24 //the rest of 'TextureHandle' holds the generation
+#define TEXTURE_DATA_MAX_GAP 16 //texture dimensions separated by at most this many unchanged ones are sent to the GPU in a single call
+#define ATLAS_PAGE_SIZE 4096 //max width & height of atlas pages, limited by 'GL_MAX_TEXTURE_SIZE'
+#define GLYPH_ATLAS_UNIT 1 //texture unit of the glyph atlas, the main atlas uses the first one
+#define DYNAMIC_ATLAS_UNIT 2 //texture unit of the atlas of color textures updated from memory
+#define DYNAMIC_R8_ATLAS_UNIT 3 //texture units of the atlases of scalar textures updated from memory, see 'DynamicTextureFormat'
+#define DYNAMIC_R16F_ATLAS_UNIT 4
+
+#define ATLAS_COMPRESSION_BC1 0x83F1 //'GL_COMPRESSED_RGBA_S3TC_DXT1_EXT', 1 bit alpha, 4 bits per pixel
+#define ATLAS_COMPRESSION_BC3 0x83F3 //'GL_COMPRESSED_RGBA_S3TC_DXT5_EXT', interpolated alpha, 8 bits per pixel
+#define ATLAS_COMPRESSION_BC7 GL_COMPRESSED_RGBA_BPTC_UNORM //8 bits per pixel, best quality
+
+#define TEXTURE_FLAG_SDF 1 //texture stores a signed distance field, see 'LoadBdfFont'
+#define TEXTURE_FLAG_GLYPH 2 //texture is stored in the single channel glyph atlas & is drawn as white with it's coverage as alpha
+#define TEXTURE_FLAG_ROTATED 4 //texture is stored in atlas with x & y swapped, width & height in it's dimensions aren't swapped
+#define TEXTURE_FLAG_DYNAMIC 8 //texture is stored in the dynamic atlas & is updated from memory, see 'CreateDynamicTexture'
+#define TEXTURE_FLAG_SCALAR 16 //texture stores a single value per pixel which is color mapped through it's palette, see 'DynamicTextureFormat'
+#define TEXTURE_FLAG_TRIMMED 32 //only a part of the image is stored in atlas, the rest is transparent, see 'TextureAtlas::TrimImages'
+#define TEXTURE_FLAG_HALF_FLOAT 64 //scalar texture stores half floats, so it's in the 'R16F' dynamic atlas instead of the 'R8' one
+
+#define SDF_SPREAD 4 //max distance stored in signed distance field glyphs, in atlas pixels
+
+#define LAZY_FONT_CAPACITY 1024 //default number of glyphs a lazy font keeps in atlas, see 'LoadBdfFontLazy'
+
+#define TEXT_CHUNK_SIZE 512 //max number of lines in a single chunk of 'TextDocument'
 
 namespace Ogl
 {
@@ -156,31 +192,197 @@ namespace Ogl
         }
     }
 
+    //linked shader program, see 'GetShader'
+    struct Shader
+    {
+        unsigned int Program = 0;
+        std::unordered_map<std::string, int> UniformLocations; //filled as uniforms are requested
+
+        int GetUniformLocation(const std::string& name);
+    };
+
     //texture data
 
-    //relative to atlas
-    struct TextureDimensions
+    //relative to atlas, aligned to match std430 layout of the shader's array
+    struct alignas(16) TextureDimensions
     {
         unsigned int X = 0;
         unsigned int Y = 0;
         unsigned int Width = 0;
         unsigned int Height = 0;
+        unsigned int Flags = 0; //'TEXTURE_FLAG_...'
+        unsigned int Page = 0; //layer of the atlas texture array
+        unsigned int Palette = 0; //index of the texture scalar values are mapped through, see 'TEXTURE_FLAG_SCALAR'
+        unsigned int OffsetX = 0; //position of the stored part in the image from it's left-bottom corner, see 'TEXTURE_FLAG_TRIMMED'
+        unsigned int OffsetY = 0;
+        unsigned int SourceWidth = 0; //size of the whole image, textures are drawn & split with it, while 'Width' & 'Height' are the stored part's
+        unsigned int SourceHeight = 0;
     };
 
-    struct Texture
+    //pixel formats of dynamic textures, see 'CreateDynamicTexture'
+    enum class DynamicTextureFormat
     {
-        std::filesystem::path Path;
-        size_t Index = 0; //index in 'Textures' and 'TextureDimensionsVector'; if index is zero then texture is invalid
+        RGBA8, //color, 4 bytes per pixel
+        R8, //scalar in [0, 1], 1 byte per pixel
+        R16F //scalar as a half float, clamped to [0, 1] when mapped, 2 bytes per pixel
+    };
+
+    //area written into a page of an atlas which doesn't keep it's pixels, freed once it's sent to GPU, see 'TextureAtlas::KeepPixels'
+    struct StagedArea
+    {
+        Rect Area; //see 'GetAtlasArea'
+        std::vector<unsigned char> Pixels; //rows go from bottom to top
+    };
+
+    //page of texture atlas, rows go from bottom to top
+    struct AtlasPage
+    {
+        RectanglePacker Packer;
+        unsigned int Width = 0;
+        unsigned int Height = 0;
+        unsigned char* Data = NULL; //copy of the page's pixels, NULL if the atlas doesn't keep them
+        std::vector<Rect> DirtyRects; //areas written since the last upload
+        std::vector<StagedArea> StagedAreas; //areas written since the last upload if the atlas doesn't keep it's pixels
+        std::vector<Rect> FreeRects; //areas of unloaded textures, reused before the page grows
+        size_t UsedPixels = 0; //area taken by loaded textures
+    };
+
+    //texture atlas made of independently packed pages, stored on GPU as layers of a single texture array
+    struct TextureAtlas
+    {
+        unsigned int Name = 0; //opengl texture id
+        unsigned int Unit = 0; //texture unit the atlas is bound to
+        unsigned int Format = GL_RGBA; //'GL_RGBA' or 'GL_RED'
+        unsigned int Channels = IMAGE_CHANNELS; //bytes per pixel
+        unsigned int StorageFormat = 0; //internal format of the texture array, 'GL_R8' or 'GL_RGBA8' depending on 'Format' if zero
+        unsigned int PageSize = 0; //max width & height of a page, set on initialization
+        PackingStrategy Strategy = PackingStrategy::MaxRects;
+        bool AllowRotation = false; //textures may be stored rotated to pack tighter, see 'TEXTURE_FLAG_ROTATED'
+        unsigned int Compression = 0; //'ATLAS_COMPRESSION_...' or 0, only for 'GL_RGBA' atlases, set before the first texture is loaded
+        unsigned int MipLevels = 1; //mip levels are generated on CPU for minified sprites, textures are then surrounded by gutters of their edge pixels, set before the first texture is loaded
+        bool KeepPixels = true; //a copy of the pages is kept in RAM, otherwise written areas are only staged until they're uploaded & pages are read back from GPU by 'DumpAtlas', set before the first texture is loaded
+        bool TrimImages = true; //fully transparent borders of images loaded by 'LoadTextures' aren't stored, see 'TEXTURE_FLAG_TRIMMED'
+        bool ShareDuplicates = true; //images with identical pixels (after trimming) loaded by 'LoadTextures' share a single area, images loaded earlier are only shared if pixels are kept
+        std::vector<AtlasPage> Pages;
+        unsigned int TextureWidth = 0; //size of the texture array on GPU, grows geometrically & can be bigger than the pages
+        unsigned int TextureHeight = 0;
+        unsigned int TextureLayers = 0;
+    };
+
+    //see 'GetAtlasMetrics'
+    struct AtlasMetrics
+    {
+        size_t PageCount = 0;
+        size_t TotalPixels = 0; //area of all pages
+        size_t UsedPixels = 0; //area taken by loaded textures
+        size_t FreePixels = 0; //area of unloaded textures available for reuse
+        float Occupancy = 0.0f; //fraction of total area taken by loaded textures
+        float Fragmentation = 0.0f; //zero if all free area is a single rect, approaches one as it's split into small pieces
+    };
+
+    //trivially copyable reference to a texture, passed to drawing methods by value
+    //indices of unloaded images are reused, the generation tells handles of the old & the new texture apart
+    struct TextureHandle
+    {
+        unsigned int Index : TEXTURE_INDEX_BITS = 0; //index in 'TextureDimensionsVector' & arrays of 'Textures'; if index is zero then texture is invalid
+        unsigned int Generation : 32 - TEXTURE_INDEX_BITS = 0; //wraps around, glyphs are never unloaded & always have zero
+    };
+
+    //texture data which isn't needed for drawing, arrays are indexed by 'TextureHandle::Index'
+    struct TextureTable
+    {
+        std::vector<unsigned char> Generations = { 0 }; //generation of the current handle of each index
+        std::unordered_map<size_t, std::filesystem::path> Paths; //paths of images loaded from files, glyphs don't have any
+        std::unordered_map<size_t, size_t> Parents; //indices of textures sub-textures point into, see 'CreateSubTexture'
+        std::unordered_map<size_t, std::vector<size_t>> SubTextures; //indices of sub-textures of each texture which has them
+        std::unordered_map<size_t, unsigned long long> ContentHashes; //hashes of stored pixels of images which can be shared, see 'TextureAtlas::ShareDuplicates'
+        std::unordered_map<unsigned long long, std::vector<size_t>> SharedContents; //indices of images with each hash, ones at the same position share an area which is freed once all of them are unloaded
+
+        TextureHandle GetHandle(size_t index) const;
+        bool IsValid(TextureHandle texture) const;
+    };
+
+    //frames of a sprite sheet loaded by 'LoadSpriteSheet', they're sub-textures of it's image
+    struct SpriteSheet
+    {
+        TextureHandle Texture; //resolved image of the sheet, releasing it unloads the frames as well
+        std::vector<TextureHandle> Frames; //in the order they're listed in the description
+        std::unordered_map<std::string, TextureHandle> FrameNames;
     };
 
+    //maps paths of resolved files to indices of their textures/fonts, see 'ResolveTexture' & 'ResolveFont'
+    //each file is registered under it's absolute normalized path & it's canonical one, so resolving the same spelling again doesn't touch the filesystem
+    //while other spellings (relative to another directory, through symlinks) cost a single canonicalization & are remembered afterwards
+    struct ResourceRegistry
+    {
+        std::unordered_map<std::string, size_t> Indices;
+        std::unordered_map<size_t, std::vector<std::string>> Keys; //all keys of each index, so that it can be removed
+        std::unordered_map<size_t, size_t> References; //number of resolutions not matched by releases
+
+        size_t Find(const std::filesystem::path& path);
+        void Add(const std::filesystem::path& path, size_t index);
+        void Remove(size_t index);
+    };
+
+    struct LazyGlyphCache; //defined in 'fonts.cpp'
+    struct TrueTypeGlyphCache;
+
     struct BitmapFont
     {
         std::filesystem::path Path;
-        unsigned int MaxWidth;
+        unsigned int MaxWidth; //in font pixels
         unsigned int MaxHeight;
+        unsigned int Scale = 1; //atlas pixels per font pixel, greater than one for signed distance field fonts
+        unsigned int Padding = 0; //atlas pixels around each glyph, used by signed distance field fonts
 
         size_t GlyphCount = 0;
         std::vector<std::tuple<unsigned int, unsigned int, size_t>> EncodingRanges; //first utf32 codepoint, second codepoint, first glyph index
+        std::shared_ptr<LazyGlyphCache> Lazy; //set for fonts loaded by 'LoadBdfFontLazy', glyph indices are then relative to the font & not to 'Textures'
+        std::shared_ptr<TrueTypeGlyphCache> TrueType; //set for fonts loaded by 'LoadTrueTypeFont', shared by all sizes of the same font
+        unsigned int PixelSize = 0; //em size of TrueType fonts, in pixels
+
+        size_t GetGlyphIndex(unsigned int codepoint) const;
+        size_t GetEvictionCount() const;
+        void PrepareGlyphs(const std::basic_string<unsigned int>& text) const;
+    };
+
+    //position of a single glyph inside of a line, in font pixels (padding of signed distance field glyphs excluded)
+    struct GlyphLayout
+    {
+        size_t TextureIndex = 0;
+        float PixelX = 0; //offset from the line's start when glyphs are drawn in their real resolution
+        float RelativeX = 0; //offset from the line's start when glyphs' height is normalized to 1
+        unsigned int Width = 0;
+        unsigned int Height = 0;
+    };
+
+    struct TextLine
+    {
+        std::basic_string<unsigned int> Text; //utf32, without the newline
+        std::vector<GlyphLayout> Layout; //cached, rebuilt only after the line has been edited
+        bool IsLayoutValid = false;
+    };
+
+    //editable text split into lines, lines are stored in chunks so that edits only move lines of a single chunk
+    //meant for documents too large to be redrawn with 'DrawText' on every change, see 'Layer::DrawDocument'
+    struct TextDocument
+    {
+        BitmapFont* Font = NULL; //used for building line layouts, 'InvalidateLayout' should be called after changing it
+        std::vector<std::vector<TextLine>> Chunks = { { TextLine {} } };
+        size_t LineCount = 1;
+
+        TextLine& GetLine(size_t index);
+        const std::vector<GlyphLayout>& GetLineLayout(size_t index);
+        std::string GetText();
+        void SetText(std::string text);
+        void Insert(size_t line, size_t column, std::string text);
+        void Append(std::string text);
+        void Erase(size_t line, size_t column, size_t count);
+        void InvalidateLayout();
+
+        std::tuple<size_t, size_t> FindLine(size_t index);
+        void InsertLines(size_t index, std::vector<TextLine>& lines);
+        void EraseLines(size_t index, size_t count);
     };
 
     //rendering layer, each layer owns a block of video memory
@@ -194,6 +396,9 @@ namespace Ogl
         bool IsWorldSpace = false; //if set objects drawn by the layer will be transformed to NDC from world coordinates by the vertex shader
         bool Redraw = false; //if set data from the previous 'Draw' call will be discarded even if nothing was generated during the last call; will be reset afterwards
         bool IsOutOfView = false; //if set layer is currently out of view and won't be drawn
+        bool IsGlyphLayer = false; //if set layer's rendering data consists of glyph instances written by 'DrawTextInstanced' instead of vertices, other drawing methods shouldn't be used
+        unsigned int ShaderFeatures = 0; //'SHADER_FEATURE_...' used by primitives written during the current 'Draw' call, set by 'WriteVertexData'
+        unsigned int BlockShaderFeatures = 0; //features of the primitives stored in layer's block of video memory, select the program it's drawn with
 
         Vec2 AabbMax = Vec2(0); //AABB of objects drawn by the layer, used for clipping (if enabled), WILL NOT BE SET WHEN USING 'WriteVertexData' DIRECTLY
         Vec2 AabbMin = Vec2(0);
@@ -231,10 +436,13 @@ namespace Ogl
             UnsubHandlers.push_back(std::function<void()>([sub]() { Ogl::Unsubscribe(sub); }));
         }
 
-        void WriteVertexData(const Vec2* coords, const Vec2* texCoords, const Color* colors, Texture texture, size_t count);
-        void DrawTriangle(Vec2 a, Vec2 b, Vec2 c, Color color = COLOR_TRANSPARENT, Texture texture = Texture{}, bool matchResolution = false);
-        void DrawRect(Vec2 a, Vec2 b, Color color = COLOR_TRANSPARENT, Texture texture = Texture {}, bool matchResolution = false, bool mirrorX = false, bool mirrorY = false, bool swapXY = false);
+        void ReserveRenderingData(size_t size);
+        void WriteVertexData(const Vec2* coords, const Vec2* texCoords, const Color* colors, TextureHandle texture, size_t count);
+        void DrawTriangle(Vec2 a, Vec2 b, Vec2 c, Color color = COLOR_TRANSPARENT, TextureHandle texture = TextureHandle {}, bool matchResolution = false);
+        void DrawRect(Vec2 a, Vec2 b, Color color = COLOR_TRANSPARENT, TextureHandle texture = TextureHandle {}, bool matchResolution = false, bool mirrorX = false, bool mirrorY = false, bool swapXY = false);
         void DrawText(Vec2 pos, std::string text, float scale, BitmapFont& font, Color color = COLOR_TRANSPARENT, bool matchResolution = false, bool multiline = true, bool bounded = false, float maxWidth = 0.0f, float maxHeight = 0.0f);
+        void DrawTextInstanced(Vec2 pos, std::string text, float scale, BitmapFont& font, Color color = COLOR_TRANSPARENT, bool matchResolution = false);
+        void DrawDocument(Vec2 pos, TextDocument& document, float scale, Color color = COLOR_TRANSPARENT, bool matchResolution = false);
         void DrawLine(Vec2 a, Vec2 b, Color color);
     };
 
@@ -271,11 +479,29 @@ namespace Ogl
     //texture methods
 
     void SetTextureFilter(unsigned int minification, unsigned int magnification);
-    std::vector<Texture> LoadTextures(std::vector<std::filesystem::path> paths);
-    BitmapFont LoadBdfFont(std::filesystem::path path);
-    std::vector<Texture> LoadTexturesFromPath(std::filesystem::path path);
-    Texture ResolveTexture(std::filesystem::path path);
-    BitmapFont ResolveFont(std::filesystem::path path);
+    std::vector<TextureHandle> LoadTextures(std::vector<std::filesystem::path> paths);
+    BitmapFont& LoadBdfFont(std::filesystem::path path, unsigned int sdfScale = 0, bool useCache = true);
+    BitmapFont& LoadBdfFontLazy(std::filesystem::path path, unsigned int sdfScale = 0, size_t capacity = LAZY_FONT_CAPACITY);
+    BitmapFont& LoadTrueTypeFont(std::filesystem::path path, unsigned int pixelSize);
+    std::vector<TextureHandle> LoadTexturesFromPath(std::filesystem::path path);
+    TextureHandle ResolveTexture(std::filesystem::path path);
+    TextureHandle LoadTextureAsync(std::filesystem::path path);
+    TextureHandle ResolveTextureAsync(std::filesystem::path path);
+    bool IsTextureResident(TextureHandle texture);
+    void UnloadTexture(TextureHandle texture);
+    void ReleaseTexture(TextureHandle texture);
+    void CompactAtlas();
+    AtlasMetrics GetAtlasMetrics(const TextureAtlas& atlas);
+    void DumpAtlas(const TextureAtlas& atlas, std::filesystem::path path);
+    void BakeAtlas(std::filesystem::path path, std::filesystem::path output, unsigned int compression = 0);
+    std::vector<TextureHandle> LoadBakedAtlas(std::filesystem::path path);
+    BitmapFont& ResolveFont(std::filesystem::path path);
+    TextureHandle CreateDynamicTexture(unsigned int width, unsigned int height, DynamicTextureFormat format = DynamicTextureFormat::RGBA8, TextureHandle palette = TextureHandle {});
+    void UpdateDynamicTexture(TextureHandle texture, const void* pixels);
+    void SetTexturePalette(TextureHandle texture, TextureHandle palette);
+    TextureHandle CreateSubTexture(TextureHandle texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+    std::vector<TextureHandle> SplitTexture(TextureHandle texture, unsigned int cellWidth, unsigned int cellHeight, size_t count = 0, unsigned int margin = 0, unsigned int spacing = 0);
+    SpriteSheet LoadSpriteSheet(std::filesystem::path path);
 
     //layer methods
 
@@ -285,6 +511,10 @@ namespace Ogl
     void ClearLayers();
     bool IsLayerOutOfView(Layer* layerPtr);
 
+    //shader methods
+
+    Shader& GetShader(const char* vertexSource, const char* fragmentSource, std::vector<std::string> defines = {});
+
     //init, update
 
     void Initialize(int windowWidth, int windowHeight, std::string windowName, bool fullscreen);
@@ -294,14 +524,16 @@ namespace Ogl
 
     inline GLFWwindow* Window;
 
-    //vertex array object
-    inline unsigned int Vao;
+    //vertex array objects, the second one is used by glyph layers
+    inline unsigned int Vao, GlyphVao;
 
     //vertex buffer object, vertex buffer copy, shader storage buffer object
     inline Buffer Vbo, VboCopy, Ssbo;
 
-    //shader uniform handles
-    inline unsigned int UniformNdcMatrix;
+    //shader programs
+    inline std::unordered_map<unsigned long long, Shader> Shaders; //keyed by hash of sources & defines, see 'GetShader'
+    inline std::filesystem::path ShaderCacheDirectory = "shadercache"; //binaries of linked programs are stored here, empty path disables the cache
+    inline Shader* TiledShader, *TexturedShader, *ColorShader, *GlyphShader; //regular layers use one of the first three depending on their 'BlockShaderFeatures'
 
     //camera data
     inline Vec2 CameraPosition; //camera's center
@@ -317,16 +549,23 @@ namespace Ogl
     inline Mat3 PixelToNDCMatrix;
 
     //texture data
-    inline unsigned int Atlas; //opengl texture id
-    inline RectanglePacker AtlasPacker;
-    inline unsigned int AtlasWidth, AtlasHeight;
-    inline unsigned char* AtlasData;
-    inline std::vector<Texture> Textures = { Texture {} }; //zero index is reserved as an invalid texture, so drawing commands will ignore it
-    inline std::vector<BitmapFont> Fonts;
+    inline TextureAtlas Atlas = { .AllowRotation = true }; //images
+    inline TextureAtlas GlyphAtlas = { .Unit = GLYPH_ATLAS_UNIT, .Format = GL_RED, .Channels = 1 }; //glyphs of all fonts, one byte of coverage/distance per pixel
+    inline TextureAtlas DynamicAtlas = { .Unit = DYNAMIC_ATLAS_UNIT, .KeepPixels = false }; //color textures updated from memory
+    inline TextureAtlas DynamicR8Atlas = { .Unit = DYNAMIC_R8_ATLAS_UNIT, .Format = GL_RED, .Channels = 1, .KeepPixels = false }; //scalar textures updated from memory, one atlas per format so none of them takes more memory than it needs
+    inline TextureAtlas DynamicR16FAtlas = { .Unit = DYNAMIC_R16F_ATLAS_UNIT, .Format = GL_RED, .Channels = 2, .StorageFormat = GL_R16F, .KeepPixels = false };
+    inline TextureTable Textures; //zero index is reserved as an invalid texture, so drawing commands will ignore it
+    inline std::deque<BitmapFont> Fonts; //all loaded fonts, loaders return references to them which stay valid as more are added
     inline std::vector<TextureDimensions> TextureDimensionsVector = { TextureDimensions {} }; //texture positions and sizes relative to atlas, storing them separately from other texture data since it must be sent to the fragment shader
     inline std::vector<size_t> TexturesToUpdate; //indices of newly added/moved textures which require their data to be resent to the GPU
+    inline size_t TextureStreamingBudget = 4 * 1024 * 1024; //max number of bytes uploaded per frame by asynchronously loaded textures
+    inline std::vector<size_t> FreeTextureIndices; //indices of unloaded textures, reused by new images
+    inline ResourceRegistry TextureRegistry; //images loaded from files & baked atlases
+    inline ResourceRegistry FontRegistry; //fonts added to 'Fonts' by 'ResolveFont'
+    inline float AtlasCompactionThreshold = 0.5f; //atlas is compacted between frames once this fraction of it is unused after unloading textures, zero disables compaction
 
     //layers
     inline size_t LastLayerId = 0;
+    inline size_t FrameIndex = 0; //number of frames drawn so far
     inline std::vector<Layer*> Layers;
 }
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+#include <ogl.hpp>
+#include <rectangle_packer.hpp>
+
+//atlas helpers shared by texture & font loaders, defined in 'textures.cpp'
+
+Ogl::TextureHandle AddTexture(Rect rect, unsigned int flags = 0, std::filesystem::path path = {});
+void UpdateTextureData();
+void UploadAtlas(Ogl::TextureAtlas& atlas);
+void InitializeAtlas(Ogl::TextureAtlas& atlas);
+void WriteToAtlas(Ogl::TextureAtlas& atlas, unsigned int page, unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height, bool flip = true, bool rotate = false);
+void PackAtlas(Ogl::TextureAtlas& atlas, std::vector<Rect>& rects);
+Rect GetAtlasArea(const Ogl::TextureAtlas& atlas, Rect rect);
+void UpdateTextureStreaming();
+void UpdateAtlasCompaction();
@@ -0,0 +1,383 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <ogl.hpp>
+#include <parallel.hpp>
+#include <block_compression.hpp>
+
+//block compression encoders
+
+void ReadBlock(const unsigned char* pixels, size_t stride, float block[16][4])
+{
+    for (int i = 0; i < 16; i++)
+    {
+        const unsigned char* pixel = pixels + stride * (i / 4) + (i % 4) * 4;
+        for (int c = 0; c < 4; c++)
+        {
+            block[i][c] = pixel[c];
+        }
+    }
+}
+
+//fits a line through pixels with 'mask' bits set & returns the ends of their projections onto it
+//the line goes along the principal axis of pixels' covariance, found by power iteration
+void FindEndpoints(const float block[16][4], int channels, unsigned int mask, float low[4], float high[4])
+{
+    float mean[4] = {}, covariance[4][4] = {};
+    int count = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if ((mask >> i & 1) == 0)
+            continue;
+
+        count++;
+        for (int c = 0; c < channels; c++)
+        {
+            mean[c] += block[i][c];
+        }
+    }
+
+    for (int c = 0; c < channels; c++)
+    {
+        mean[c] /= std::max(count, 1);
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        if ((mask >> i & 1) == 0)
+            continue;
+
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+            {
+                covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+            }
+        }
+    }
+
+    float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {}, length = 0.0f;
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+            {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+
+        length = std::sqrt(length);
+        if (length < 1e-6f)
+            break; //all pixels are the same
+
+        for (int c = 0; c < channels; c++)
+        {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float minProjection = 0.0f, maxProjection = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        if ((mask >> i & 1) == 0)
+            continue;
+
+        float projection = 0.0f;
+        for (int c = 0; c < channels; c++)
+        {
+            projection += (block[i][c] - mean[c]) * axis[c];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    for (int c = 0; c < channels; c++)
+    {
+        low[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+    }
+}
+
+unsigned int ToRgb565(const float color[4])
+{
+    unsigned int r = static_cast<unsigned int>(color[0] * 31.0f / 255.0f + 0.5f);
+    unsigned int g = static_cast<unsigned int>(color[1] * 63.0f / 255.0f + 0.5f);
+    unsigned int b = static_cast<unsigned int>(color[2] * 31.0f / 255.0f + 0.5f);
+    return r << 11 | g << 5 | b;
+}
+
+void FromRgb565(unsigned int color, float result[4])
+{
+    unsigned int r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+    result[0] = static_cast<float>(r << 3 | r >> 2);
+    result[1] = static_cast<float>(g << 2 | g >> 4);
+    result[2] = static_cast<float>(b << 3 | b >> 2);
+}
+
+void WriteLittleEndian(unsigned char* data, unsigned long long value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        data[i] = value >> (i * 8) & 0xFF;
+    }
+}
+
+//8 bytes of BC1 color data, pixels with alpha below 128 are transparent if 'allowTransparency' is set (BC3 always uses 4 colors)
+void EncodeColorBlock(const float block[16][4], bool allowTransparency, unsigned char* result)
+{
+    unsigned int opaqueMask = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        opaqueMask |= (!allowTransparency || block[i][3] >= 128.0f ? 1u : 0u) << i;
+    }
+
+    //3 colors & transparency are used if the first endpoint isn't greater than the second one
+    bool hasTransparency = opaqueMask != 0xFFFF;
+    float low[4], high[4];
+    FindEndpoints(block, 3, opaqueMask, low, high);
+    unsigned int color0 = ToRgb565(high), color1 = ToRgb565(low);
+    if (hasTransparency ? color0 > color1 : color0 < color1)
+        std::swap(color0, color1);
+
+    float palette[4][4];
+    FromRgb565(color0, palette[0]);
+    FromRgb565(color1, palette[1]);
+    int paletteSize = hasTransparency ? 3 : 4;
+    for (int c = 0; c < 3; c++)
+    {
+        if (hasTransparency)
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] * 2.0f + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + palette[1][c] * 2.0f) / 3.0f;
+        }
+    }
+
+    unsigned int indices = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        unsigned int index = 3; //transparent
+        if ((opaqueMask >> i & 1) != 0 && color0 != color1)
+        {
+            float minError = INFINITY;
+            for (int j = 0; j < paletteSize; j++)
+            {
+                float error = 0.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    error += (block[i][c] - palette[j][c]) * (block[i][c] - palette[j][c]);
+                }
+
+                if (error < minError)
+                {
+                    minError = error;
+                    index = j;
+                }
+            }
+        }
+        else if ((opaqueMask >> i & 1) != 0)
+        {
+            index = 0;
+        }
+
+        indices |= index << (i * 2);
+    }
+
+    WriteLittleEndian(result, color0, 2);
+    WriteLittleEndian(result + 2, color1, 2);
+    WriteLittleEndian(result + 4, indices, 4);
+}
+
+void EncodeBc1Block(const unsigned char* pixels, size_t stride, unsigned char* block)
+{
+    float values[16][4];
+    ReadBlock(pixels, stride, values);
+    EncodeColorBlock(values, true, block);
+}
+
+void EncodeBc3Block(const unsigned char* pixels, size_t stride, unsigned char* block)
+{
+    float values[16][4];
+    ReadBlock(pixels, stride, values);
+
+    //alpha endpoints with 6 values interpolated between them
+    unsigned int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; i++)
+    {
+        alpha0 = std::max(alpha0, static_cast<unsigned int>(values[i][3]));
+        alpha1 = std::min(alpha1, static_cast<unsigned int>(values[i][3]));
+    }
+
+    float palette[8] = { static_cast<float>(alpha0), static_cast<float>(alpha1) };
+    for (int i = 2; i < 8; i++)
+    {
+        palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1]) / 7.0f;
+    }
+
+    unsigned long long indices = 0;
+    for (int i = 0; i < 16 && alpha0 != alpha1; i++)
+    {
+        unsigned long long index = 0;
+        float minError = INFINITY;
+        for (int j = 0; j < 8; j++)
+        {
+            float error = std::abs(values[i][3] - palette[j]);
+            if (error < minError)
+            {
+                minError = error;
+                index = j;
+            }
+        }
+
+        indices |= index << (i * 3);
+    }
+
+    block[0] = alpha0;
+    block[1] = alpha1;
+    WriteLittleEndian(block + 2, indices, 6);
+    EncodeColorBlock(values, false, block + 8);
+}
+
+//writes values into a block starting from the least significant bit of the first byte
+struct BitWriter
+{
+    unsigned char* Data;
+    int Position = 0;
+
+    void Write(unsigned int value, int bits)
+    {
+        for (int i = 0; i < bits; i++, Position++)
+        {
+            Data[Position / 8] |= (value >> i & 1) << (Position % 8);
+        }
+    }
+};
+
+//mode 6: a single pair of RGBA endpoints with 7 bits per channel & a shared lowest bit for each endpoint, 4 bit indices
+void EncodeBc7Block(const unsigned char* pixels, size_t stride, unsigned char* block)
+{
+    const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float values[16][4];
+    ReadBlock(pixels, stride, values);
+
+    float endpoints[2][4];
+    FindEndpoints(values, 4, 0xFFFF, endpoints[0], endpoints[1]);
+
+    //choosing the lowest bit of each endpoint which gives the smallest quantization error
+    unsigned int quantized[2][4], lowestBits[2];
+    int reconstructed[2][4];
+    for (int e = 0; e < 2; e++)
+    {
+        float minError = INFINITY;
+        for (unsigned int bit = 0; bit < 2; bit++)
+        {
+            float error = 0.0f;
+            unsigned int candidate[4];
+            for (int c = 0; c < 4; c++)
+            {
+                candidate[c] = std::clamp(static_cast<int>(std::round((endpoints[e][c] - bit) / 2.0f)), 0, 127);
+                float value = static_cast<float>(candidate[c] << 1 | bit);
+                error += (value - endpoints[e][c]) * (value - endpoints[e][c]);
+            }
+
+            if (error < minError)
+            {
+                minError = error;
+                lowestBits[e] = bit;
+                std::copy(candidate, candidate + 4, quantized[e]);
+            }
+        }
+
+        for (int c = 0; c < 4; c++)
+        {
+            reconstructed[e][c] = quantized[e][c] << 1 | lowestBits[e];
+        }
+    }
+
+    unsigned int indices[16];
+    for (int i = 0; i < 16; i++)
+    {
+        float minError = INFINITY;
+        for (int j = 0; j < 16; j++)
+        {
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                float value = static_cast<float>(((64 - weights[j]) * reconstructed[0][c] + weights[j] * reconstructed[1][c] + 32) >> 6);
+                error += (values[i][c] - value) * (values[i][c] - value);
+            }
+
+            if (error < minError)
+            {
+                minError = error;
+                indices[i] = j;
+            }
+        }
+    }
+
+    //the highest bit of the first index isn't stored & must be zero, so endpoints are swapped if it's set
+    if (indices[0] >= 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(lowestBits[0], lowestBits[1]);
+        for (unsigned int& index : indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    std::fill(block, block + 16, 0);
+    BitWriter writer = { block };
+    writer.Write(1 << 6, 7);
+    for (int c = 0; c < 4; c++)
+    {
+        writer.Write(quantized[0][c], 7);
+        writer.Write(quantized[1][c], 7);
+    }
+    writer.Write(lowestBits[0], 1);
+    writer.Write(lowestBits[1], 1);
+    for (int i = 0; i < 16; i++)
+    {
+        writer.Write(indices[i], i == 0 ? 3 : 4);
+    }
+}
+
+size_t GetCompressedBlockSize(unsigned int format)
+{
+    switch (format)
+    {
+    case ATLAS_COMPRESSION_BC1:
+        return 8;
+    case ATLAS_COMPRESSION_BC3:
+    case ATLAS_COMPRESSION_BC7:
+        return 16;
+    default:
+        throw std::runtime_error(std::format("Unsupported compression format: {}.", format));
+    }
+}
+
+void CompressRegion(unsigned int format, const unsigned char* pixels, size_t stride, unsigned int width, unsigned int height, unsigned char* output)
+{
+    if (width % 4 != 0 || height % 4 != 0)
+        throw std::runtime_error("Compressed region must consist of whole blocks.");
+
+    size_t blockSize = GetCompressedBlockSize(format);
+    void (*encode)(const unsigned char*, size_t, unsigned char*) =
+        format == ATLAS_COMPRESSION_BC1 ? EncodeBc1Block : format == ATLAS_COMPRESSION_BC3 ? EncodeBc3Block : EncodeBc7Block;
+
+    unsigned int blocksX = width / 4;
+    ParallelFor(height / 4, [&](size_t y)
+    {
+        for (unsigned int x = 0; x < blocksX; x++)
+        {
+            encode(pixels + stride * y * 4 + x * 16, stride, output + (y * blocksX + x) * blockSize);
+        }
+    });
+}
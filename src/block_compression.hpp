@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+//CPU encoders of BCn block compression formats, pixels are RGBA8 & are encoded in blocks of 4x4
+//BC1 stores colors with 1 bit alpha in 8 bytes per block, BC3 adds 8 bytes of interpolated alpha, BC7 uses mode 6 only (16 bytes per block)
+
+void EncodeBc1Block(const unsigned char* pixels, size_t stride, unsigned char* block);
+void EncodeBc3Block(const unsigned char* pixels, size_t stride, unsigned char* block);
+void EncodeBc7Block(const unsigned char* pixels, size_t stride, unsigned char* block);
+
+//'format' is one of 'ATLAS_COMPRESSION_...'
+size_t GetCompressedBlockSize(unsigned int format);
+
+//encodes 'width' x 'height' area (both multiples of 4) starting at 'pixels', rows being 'stride' bytes apart
+//blocks are written row by row as expected by 'glCompressedTexSubImage', rows of blocks are encoded on all hardware threads
+void CompressRegion(unsigned int format, const unsigned char* pixels, size_t stride, unsigned int width, unsigned int height, unsigned char* output);
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define DISTANCE_INFINITY 1e20
+
+//squared euclidean distance transform of a sampled function (Felzenszwalb & Huttenlocher)
+//'v' & 'z' are scratch buffers of at least 'count' and 'count' + 1 elements
+inline void DistanceTransform(const double* f, double* d, int count, std::vector<int>& v, std::vector<double>& z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -DISTANCE_INFINITY;
+    z[1] = DISTANCE_INFINITY;
+
+    for (int q = 1; q < count; q++)
+    {
+        double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            k--;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = DISTANCE_INFINITY;
+    }
+
+    k = 0;
+    for (int q = 0; q < count; q++)
+    {
+        while (z[k + 1] < q)
+            k++;
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+//replaces each value of the grid with the squared distance to the closest zero value
+//non-zero values should be set to 'DISTANCE_INFINITY'
+inline void DistanceTransform(std::vector<double>& grid, unsigned int width, unsigned int height)
+{
+    size_t maxSize = std::max(width, height);
+    std::vector<double> in(maxSize), out(maxSize);
+    std::vector<int> v(maxSize);
+    std::vector<double> z(maxSize + 1);
+
+    for (unsigned int x = 0; x < width; x++)
+    {
+        for (unsigned int y = 0; y < height; y++)
+        {
+            in[y] = grid[y * width + x];
+        }
+
+        DistanceTransform(in.data(), out.data(), height, v, z);
+
+        for (unsigned int y = 0; y < height; y++)
+        {
+            grid[y * width + x] = out[y];
+        }
+    }
+
+    for (unsigned int y = 0; y < height; y++)
+    {
+        std::copy(grid.begin() + y * width, grid.begin() + (y + 1) * width, in.begin());
+        DistanceTransform(in.data(), grid.data() + y * width, width, v, z);
+    }
+}
+
+//converts 'coverage' ('width' x 'height' bytes, non-zero values are inside of the shape) into a signed distance field
+//coverage is upscaled by 'scale' and padded by 'spread' pixels on each side, so the result is (width * scale + 2 * spread) x (height * scale + 2 * spread)
+//distances are mapped to [0, 255] with the shape's edge at 128 and 'spread' pixels being the max distance in both directions
+inline std::vector<unsigned char> GenerateDistanceField(const unsigned char* coverage, unsigned int width, unsigned int height, unsigned int scale, unsigned int spread)
+{
+    unsigned int resultWidth = width * scale + 2 * spread;
+    unsigned int resultHeight = height * scale + 2 * spread;
+    size_t size = static_cast<size_t>(resultWidth) * resultHeight;
+
+    //distances to the closest inside pixel & to the closest outside pixel
+    std::vector<double> toInside(size, DISTANCE_INFINITY);
+    std::vector<double> toOutside(size, 0.0);
+    for (unsigned int y = 0; y < height * scale; y++)
+    {
+        for (unsigned int x = 0; x < width * scale; x++)
+        {
+            if (coverage[(y / scale) * width + x / scale] == 0)
+                continue;
+
+            size_t index = (y + spread) * resultWidth + x + spread;
+            toInside[index] = 0.0;
+            toOutside[index] = DISTANCE_INFINITY;
+        }
+    }
+
+    DistanceTransform(toInside, resultWidth, resultHeight);
+    DistanceTransform(toOutside, resultWidth, resultHeight);
+
+    std::vector<unsigned char> result(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        //distances are between pixel centers, so the edge lies half a pixel away from them
+        double distance = toInside[i] == 0.0 ? std::sqrt(toOutside[i]) - 0.5 : 0.5 - std::sqrt(toInside[i]);
+        float value = 0.5f + static_cast<float>(distance) / (2.0f * spread);
+        result[i] = static_cast<unsigned char>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    return result;
+}
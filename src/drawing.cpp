@@ -3,19 +3,36 @@
 
 //drawing methods
 
-//writes 'count' vertices to the buffer 'buf' of size 'size'
-//null can be passed to 'texCoords' and 'colors' parameters to omit them
-void Ogl::Layer::WriteVertexData(const Vec2* coords, const Vec2* texCoords, const Color* colors, Texture texture, size_t count)
+//makes sure that at least 'size' more bytes can be written to the rendering data
+void Ogl::Layer::ReserveRenderingData(size_t size)
 {
-    if (RenderingDataSize - RenderingDataUsed < count * VERT_SIZE)
+    if (RenderingDataSize - RenderingDataUsed < size)
     {
         char* oldData = RenderingData;
         size_t oldSize = RenderingDataSize;
-        RenderingDataSize = RenderingDataSize * 2 + count * VERT_SIZE;
+        RenderingDataSize = RenderingDataSize * 2 + size;
         RenderingData = new char[RenderingDataSize];
         std::memcpy(RenderingData, oldData, oldSize);
         delete[] oldData;
     }
+}
+
+//writes 'count' vertices to the buffer 'buf' of size 'size'
+//null can be passed to 'texCoords' and 'colors' parameters to omit them
+//also records whether the vertices are textured & whether their texture is repeated, see 'SHADER_FEATURE_...'
+void Ogl::Layer::WriteVertexData(const Vec2* coords, const Vec2* texCoords, const Color* colors, TextureHandle texture, size_t count)
+{
+    ReserveRenderingData(count * VERT_SIZE);
+
+    if (texture.Index != 0)
+    {
+        ShaderFeatures |= SHADER_FEATURE_TEXTURES;
+        for (int i = 0; i < count && texCoords != NULL; i++)
+        {
+            if (texCoords[i].X < 0 || texCoords[i].X > 1 || texCoords[i].Y < 0 || texCoords[i].Y > 1)
+                ShaderFeatures |= SHADER_FEATURE_TILING;
+        }
+    }
 
     char* data = RenderingData + RenderingDataUsed;
     for (int i = 0; i < count; i++)
@@ -41,7 +58,7 @@ void Ogl::Layer::WriteVertexData(const Vec2* coords, const Vec2* texCoords, cons
 //draws a triangle from three points in world/screen space (depending on layer's space) with the specified texture
 //'color' is modulate color (alpha can be set to zero to ignore it)
 //if 'matchResolution' is set the texture will be matched to it's real resolution, otherwise stretched to fully fit the triangle
-void Ogl::Layer::DrawTriangle(Vec2 a, Vec2 b, Vec2 c, Color color, Texture texture, bool matchResolution)
+void Ogl::Layer::DrawTriangle(Vec2 a, Vec2 b, Vec2 c, Color color, TextureHandle texture, bool matchResolution)
 {
     const Vec2 coords[3] = { a, b, c };
 
@@ -54,8 +71,8 @@ void Ogl::Layer::DrawTriangle(Vec2 a, Vec2 b, Vec2 c, Color color, Texture textu
     if (matchResolution)
     {
         texSize = SizeToPixels(aabb, IsWorldSpace);
-        texSize.X /= dimensions.Width;
-        texSize.Y /= dimensions.Height;
+        texSize.X /= dimensions.SourceWidth;
+        texSize.Y /= dimensions.SourceHeight;
     }
 
     const Vec2 texCoords[3] =
@@ -77,7 +94,7 @@ void Ogl::Layer::DrawTriangle(Vec2 a, Vec2 b, Vec2 c, Color color, Texture textu
 //if 'matchResolution' is set then the texture will be matched to it's real resolution, otherwise stretched to fully fit the rectangle
 //if 'mirrorX'/'mirrorY' is set then the texture will be mirrored
 //if 'swapXY' is set then the texture will be drawn as if it's rotated by 90 degrees counter-clockwise
-void Ogl::Layer::DrawRect(Vec2 a, Vec2 b, Color color, Texture texture, bool matchResolution, bool mirrorX, bool mirrorY, bool swapXY)
+void Ogl::Layer::DrawRect(Vec2 a, Vec2 b, Color color, TextureHandle texture, bool matchResolution, bool mirrorX, bool mirrorY, bool swapXY)
 {
     const Vec2 coords[6] =
     {
@@ -94,8 +111,8 @@ void Ogl::Layer::DrawRect(Vec2 a, Vec2 b, Color color, Texture texture, bool mat
     if (matchResolution)
     {
         texSize = SizeToPixels((a - b).Abs(), IsWorldSpace);
-        texSize.X /= dimensions.Width;
-        texSize.Y /= dimensions.Height;
+        texSize.X /= dimensions.SourceWidth;
+        texSize.Y /= dimensions.SourceHeight;
     }
 
     Vec2 texLb = Vec2(0);
@@ -150,6 +167,7 @@ void Ogl::Layer::DrawText(Vec2 pos, std::string text, float scale, BitmapFont& f
 {
     static std::wstring_convert<std::codecvt_utf8<unsigned int>, unsigned int> utf8converter;
     std::basic_string<unsigned int> textUtf32 = utf8converter.from_bytes(text);
+    font.PrepareGlyphs(textUtf32);
     float lineHeight = (matchResolution ? Ogl::SizeFromPixels(Vec2(font.MaxHeight), IsWorldSpace).X : 1.0f) * scale;
     Vec2 currentPos = pos;
 
@@ -162,24 +180,19 @@ void Ogl::Layer::DrawText(Vec2 pos, std::string text, float scale, BitmapFont& f
             continue;
         }
         
-        size_t index = -1;
-        for (auto& [startCodepoint, endCodepoint, startIndex] : font.EncodingRanges)
-        {
-            if (codepoint >= startCodepoint && codepoint <= endCodepoint)
-            {
-                index = startIndex + codepoint - startCodepoint;
-                break;
-            }
-        }
-
+        size_t index = font.GetGlyphIndex(codepoint);
         if (index == -1)
             throw std::runtime_error("Character unsupported by font.");
 
-        Texture characterTexture = Textures[index];
+        TextureHandle characterTexture = Textures.GetHandle(index);
         TextureDimensions dimensions = Ogl::TextureDimensionsVector[characterTexture.Index];
-        Vec2 characterSize = (matchResolution ? 
-            Ogl::SizeFromPixels(Vec2(dimensions.Width, dimensions.Height), IsWorldSpace) :
-            Vec2(static_cast<float>(dimensions.Width) / dimensions.Height, 1.0f)) * scale;
+
+        //glyph's size in font pixels, size of a single font pixel & padding around the glyph (for signed distance field fonts)
+        Vec2 glyphSize = Vec2(dimensions.Width - font.Padding * 2.0f, dimensions.Height - font.Padding * 2.0f) / font.Scale;
+        Vec2 fontPixel = matchResolution ? Ogl::SizeFromPixels(Vec2(1), IsWorldSpace) * scale : Vec2(scale / glyphSize.Y);
+        Vec2 padding = fontPixel * (static_cast<float>(font.Padding) / font.Scale);
+
+        Vec2 characterSize = Vec2(glyphSize.X * fontPixel.X, glyphSize.Y * fontPixel.Y);
         Vec2 upperRightPoint = currentPos + characterSize;
 
         if (bounded)
@@ -195,7 +208,7 @@ void Ogl::Layer::DrawText(Vec2 pos, std::string text, float scale, BitmapFont& f
                 break;
         }
 
-        DrawRect(currentPos, upperRightPoint, color, characterTexture);
+        DrawRect(currentPos - padding, upperRightPoint + padding, color, characterTexture);
         currentPos.X = upperRightPoint.X;
     }
 
@@ -204,6 +217,139 @@ void Ogl::Layer::DrawText(Vec2 pos, std::string text, float scale, BitmapFont& f
     AabbMin = Vec2::Min(AabbMin, Vec2::Min(topLeft, currentPos));
 }
 
+//FOR GLYPH LAYERS ONLY ('IsGlyphLayer' must be set)
+//same as 'DrawText' with 'multiline' set, but writes a single instance per glyph instead of 6 vertices, quads are built by the vertex shader
+void Ogl::Layer::DrawTextInstanced(Vec2 pos, std::string text, float scale, BitmapFont& font, Color color, bool matchResolution)
+{
+    if (!IsGlyphLayer)
+        throw std::runtime_error("Instanced text can only be drawn by glyph layers.");
+
+    static std::wstring_convert<std::codecvt_utf8<unsigned int>, unsigned int> utf8converter;
+    std::basic_string<unsigned int> textUtf32 = utf8converter.from_bytes(text);
+    font.PrepareGlyphs(textUtf32);
+
+    Vec2 pixelSize = SizeFromPixels(Vec2(1), IsWorldSpace) * scale;
+    float lineHeight = (matchResolution ? pixelSize.Y * font.MaxHeight : 1.0f * scale);
+    Vec2 currentPos = pos;
+
+    ReserveRenderingData(textUtf32.size() * GLYPH_INSTANCE_SIZE);
+    char* data = RenderingData + RenderingDataUsed;
+
+    for (unsigned int codepoint : textUtf32)
+    {
+        if (codepoint == '\n')
+        {
+            currentPos.X = pos.X;
+            currentPos.Y -= lineHeight;
+            continue;
+        }
+
+        size_t index = font.GetGlyphIndex(codepoint);
+        if (index == -1)
+            throw std::runtime_error("Character unsupported by font.");
+
+        //glyph's size in font pixels, size of a single font pixel & padding around the glyph (for signed distance field fonts)
+        TextureDimensions dimensions = Ogl::TextureDimensionsVector[index];
+        Vec2 glyphSize = Vec2(dimensions.Width - font.Padding * 2.0f, dimensions.Height - font.Padding * 2.0f) / font.Scale;
+        Vec2 fontPixel = matchResolution ? pixelSize : Vec2(scale / glyphSize.Y);
+        Vec2 padding = fontPixel * (static_cast<float>(font.Padding) / font.Scale);
+        Vec2 glyphScale = fontPixel / font.Scale; //size of a single atlas pixel
+
+        *reinterpret_cast<float*>(data) = currentPos.X - padding.X;
+        *reinterpret_cast<float*>(data + sizeof(float)) = currentPos.Y - padding.Y;
+        *reinterpret_cast<float*>(data + 2 * sizeof(float)) = glyphScale.X;
+        *reinterpret_cast<float*>(data + 3 * sizeof(float)) = glyphScale.Y;
+        *reinterpret_cast<unsigned int*>(data + 4 * sizeof(float)) = index;
+        *reinterpret_cast<unsigned int*>(data + 4 * sizeof(float) + sizeof(unsigned int)) = color.Uint;
+        data += GLYPH_INSTANCE_SIZE;
+
+        currentPos.X += glyphSize.X * fontPixel.X;
+    }
+
+    RenderingDataUsed = data - RenderingData;
+
+    Vec2 topLeft = Vec2(pos.X, pos.Y - font.MaxHeight * scale);
+    AabbMax = Vec2::Max(AabbMax, Vec2::Max(topLeft, currentPos + Vec2(0, lineHeight)));
+    AabbMin = Vec2::Min(AabbMin, Vec2::Min(topLeft, currentPos));
+}
+
+//draws a document line by line, same as 'DrawText' with 'multiline' set
+//only lines & glyphs intersecting camera's view are drawn, so the layer should be redrawn after the camera has moved
+//layout of each line is cached by the document, so only lines changed since the last call are rebuilt
+void Ogl::Layer::DrawDocument(Vec2 pos, TextDocument& document, float scale, Color color, bool matchResolution)
+{
+    if (document.Font == NULL)
+        throw std::runtime_error("Document has no font set.");
+
+    //view bounds
+    Vec2 viewMax = Vec2(1);
+    Vec2 viewMin = Vec2(-1);
+    if (IsWorldSpace)
+    {
+        const Vec2 corners[4] = { Vec2(-1, -1), Vec2(-1, 1), Vec2(1, -1), Vec2(1, 1) };
+        viewMax = viewMin = NDCToWorldMatrix.TransformVector(corners[0]);
+        for (Vec2 corner : corners)
+        {
+            Vec2 point = NDCToWorldMatrix.TransformVector(corner);
+            viewMax = Vec2::Max(viewMax, point);
+            viewMin = Vec2::Min(viewMin, point);
+        }
+    }
+
+    Vec2 pixelSize = SizeFromPixels(Vec2(1), IsWorldSpace) * scale;
+    float lineHeight = (matchResolution ? pixelSize.Y * document.Font->MaxHeight : 1.0f * scale);
+    float paddingPixels = static_cast<float>(document.Font->Padding) / document.Font->Scale; //around glyphs of signed distance field fonts
+
+    //line 'i' occupies [pos.Y - i * lineHeight, pos.Y - i * lineHeight + lineHeight] vertically
+    float firstLine = std::floor((pos.Y - viewMax.Y) / lineHeight);
+    float lastLine = std::floor((pos.Y + lineHeight - viewMin.Y) / lineHeight);
+    if (lastLine < 0 || firstLine >= static_cast<float>(document.LineCount))
+        return;
+
+    size_t first = static_cast<size_t>(std::max(firstLine, 0.0f));
+    size_t last = std::min(static_cast<size_t>(lastLine), document.LineCount - 1);
+
+    //glyphs of visible lines missing from atlas are rasterized at once
+    if (document.Font->TrueType)
+    {
+        std::basic_string<unsigned int> visibleText;
+        for (size_t i = first; i <= last; i++)
+        {
+            visibleText.append(document.GetLine(i).Text);
+        }
+        document.Font->PrepareGlyphs(visibleText);
+    }
+
+    for (size_t i = first; i <= last; i++)
+    {
+        const std::vector<GlyphLayout>& layout = document.GetLineLayout(i);
+        const std::basic_string<unsigned int>& text = document.GetLine(i).Text;
+        float y = pos.Y - i * lineHeight;
+
+        //skipping glyphs to the left of the view
+        auto glyph = std::lower_bound(layout.begin(), layout.end(), viewMin.X, [&](const GlyphLayout& glyph, float x)
+        {
+            float right = matchResolution ? (glyph.PixelX + glyph.Width) * pixelSize.X : (glyph.RelativeX + static_cast<float>(glyph.Width) / glyph.Height) * scale;
+            return pos.X + right < x;
+        });
+
+        for (; glyph != layout.end(); glyph++)
+        {
+            Vec2 lowerLeftPoint = Vec2(pos.X + (matchResolution ? glyph->PixelX * pixelSize.X : glyph->RelativeX * scale), y);
+            if (lowerLeftPoint.X > viewMax.X)
+                break;
+
+            Vec2 fontPixel = matchResolution ? pixelSize : Vec2(scale / glyph->Height);
+            Vec2 characterSize = Vec2(glyph->Width * fontPixel.X, glyph->Height * fontPixel.Y);
+            Vec2 padding = fontPixel * paddingPixels;
+
+            //glyphs of lazy fonts could've been evicted since the layout was built
+            size_t textureIndex = document.Font->Lazy ? document.Font->GetGlyphIndex(text[glyph - layout.begin()]) : glyph->TextureIndex;
+            DrawRect(lowerLeftPoint - padding, lowerLeftPoint + characterSize + padding, color, Textures.GetHandle(textureIndex));
+        }
+    }
+}
+
 //FOR LAYERS USING "GL_LINES" PRIMITIVE
 void Ogl::Layer::DrawLine(Vec2 a, Vec2 b, Color color)
 {
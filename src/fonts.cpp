@@ -0,0 +1,946 @@
+#include <cstring>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <ogl.hpp>
+#include <rectangle_packer.hpp>
+#include <distance_field.hpp>
+#include <parallel.hpp>
+#include <mapped_file.hpp>
+#include <atlas.hpp>
+#include <stb_truetype.h>
+
+#define FONT_CACHE_VERSION 1
+
+//font methods
+
+//glyph found in a BDF file, bitmap isn't read until the glyph is rasterized
+struct BdfGlyph
+{
+    int Codepoint = -1;
+    unsigned int Width = 0; //cell size, including offsets
+    unsigned int Height = 0;
+    unsigned int BitmapWidth = 0;
+    unsigned int BitmapHeight = 0;
+    unsigned int BitmapX = 0; //position of the bitmap inside of the cell, from the top-left corner
+    unsigned int BitmapY = 0;
+    size_t BitmapOffset = 0; //offset of the first bitmap row in the file
+};
+
+//lookup table of hexadecimal digit values, invalid digits are zero
+const std::array<unsigned char, 256> HexDigitValues = []()
+{
+    std::array<unsigned char, 256> values = {};
+    for (int i = 0; i < 10; i++)
+    {
+        values['0' + i] = i;
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        values['A' + i] = values['a' + i] = 10 + i;
+    }
+    return values;
+}();
+
+//lookup table expanding each byte of a bitmap into 8 pixels, leftmost pixel is the highest bit
+template <class T>
+std::array<std::array<T, 8>, 256> MakeBitExpansionTable(T value)
+{
+    std::array<std::array<T, 8>, 256> table = {};
+    for (int byte = 0; byte < 256; byte++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            table[byte][i] = byte & (0x80 >> i) ? value : 0;
+        }
+    }
+    return table;
+}
+
+const std::array<std::array<unsigned char, 8>, 256> CoverageExpansionTable = MakeBitExpansionTable<unsigned char>(0xFF);
+
+//decodes a glyph's bitmap into 'pixels' starting from the top row, rows are 'stride' pixels apart (negative stride writes them upwards)
+//each row is a hexadecimal number padded to whole bytes, every byte is expanded into 8 pixels with a single copy
+template <class T>
+void DecodeBdfBitmap(const MappedFile& file, const BdfGlyph& glyph, T* pixels, ptrdiff_t stride, const std::array<std::array<T, 8>, 256>& table)
+{
+    const char* row = file.Data + glyph.BitmapOffset;
+    const char* fileEnd = file.Data + file.Size;
+    unsigned int rowBytes = (glyph.BitmapWidth + 7) / 8;
+
+    for (unsigned int y = 0; y < glyph.BitmapHeight; y++)
+    {
+        const char* rowEnd = static_cast<const char*>(std::memchr(row, '\n', fileEnd - row));
+        if (rowEnd == NULL)
+            rowEnd = fileEnd;
+
+        if (rowEnd - row < rowBytes * 2)
+            throw std::runtime_error("Glyph's bitmap row is too short.");
+
+        T* rowPixels = pixels + stride * y;
+        for (unsigned int i = 0; i < rowBytes; i++)
+        {
+            unsigned char byte = HexDigitValues[static_cast<unsigned char>(row[i * 2])] << 4 | HexDigitValues[static_cast<unsigned char>(row[i * 2 + 1])];
+            unsigned int count = std::min(8u, glyph.BitmapWidth - i * 8);
+            std::memcpy(rowPixels + i * 8, table[byte].data(), count * sizeof(T));
+        }
+
+        row = rowEnd + 1;
+    }
+}
+
+//reads integers separated by whitespaces from the [start, end) range, returns false if there are less than 'count' of them
+bool ParseIntegers(const char* start, const char* end, int* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        while (start < end && (*start == ' ' || *start == '\t'))
+            start++;
+
+        std::from_chars_result result = std::from_chars(start, end, values[i]);
+        if (result.ec != std::errc())
+            return false;
+        start = result.ptr;
+    }
+
+    return true;
+}
+
+bool StartsWith(const char* start, const char* end, std::string_view keyword)
+{
+    return end - start >= keyword.size() && std::memcmp(start, keyword.data(), keyword.size()) == 0;
+}
+
+//glyphs of a single font packed into one block of coverage/distance pixels, the whole block is placed into the atlas as a single rect
+struct FontBlock
+{
+    unsigned int MaxWidth = 0;
+    unsigned int MaxHeight = 0;
+    unsigned int Scale = 1;
+    unsigned int Padding = 0;
+
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+    std::vector<std::tuple<unsigned int, unsigned int, size_t>> EncodingRanges; //same as font's, but glyph indices are relative to the block
+    std::vector<Rect> GlyphRects; //relative to the block, sorted by encoding
+
+    const unsigned char* Pixels = NULL; //one byte per pixel, bottom row first (same as atlas)
+    std::vector<unsigned char> PixelStorage; //owns 'Pixels' if the block was built from the font file
+    std::unique_ptr<MappedFile> Cache; //owns 'Pixels' if the block was read from cache
+};
+
+//tokenizes a BDF file in a single pass which only records glyphs' sizes & where their bitmaps are, glyphs are returned sorted by encoding
+std::vector<BdfGlyph> ParseBdfGlyphs(const MappedFile& file, unsigned int& maxWidth, unsigned int& maxHeight)
+{
+    std::vector<BdfGlyph> glyphs;
+    const int maxOffset = 256; //max x/y offset
+    const char* fileEnd = file.Data + file.Size;
+    const char* line = file.Data;
+    while (line < fileEnd)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', fileEnd - line));
+        if (lineEnd == NULL)
+            lineEnd = fileEnd;
+
+        //font end
+        if (StartsWith(line, lineEnd, "ENDFONT"))
+            break;
+
+        //new glyph
+        if (StartsWith(line, lineEnd, "STARTCHAR"))
+            glyphs.emplace_back();
+
+        //settings glyph's encoding
+        if (StartsWith(line, lineEnd, "ENCODING") && !glyphs.empty())
+        {
+            if (!ParseIntegers(line + 8, lineEnd, &glyphs.back().Codepoint, 1))
+                throw std::runtime_error("Invalid glyph encoding.");
+        }
+
+        //glyph's bitmap size & offsets
+        if (StartsWith(line, lineEnd, "BBX") && !glyphs.empty())
+        {
+            BdfGlyph& glyph = glyphs.back();
+            int values[4]; //width, height, x offset, y offset
+            if (!ParseIntegers(line + 3, lineEnd, values, 4) || values[0] < 0 || values[1] < 0)
+                throw std::runtime_error("Invalid glyph bounding box.");
+
+            auto [width, height, offsetX, offsetY] = values;
+            if (offsetX > maxOffset || offsetY > maxOffset)
+                throw std::runtime_error("Glyph X/Y offset is too high.");
+
+            glyph.BitmapWidth = width;
+            glyph.BitmapHeight = height;
+            glyph.BitmapX = std::max(-offsetX, 0);
+            glyph.BitmapY = std::max(-offsetY, 0);
+            glyph.Width = width + std::abs(offsetX);
+            glyph.Height = height + std::abs(offsetY);
+
+            maxWidth = std::max(maxWidth, glyph.Width);
+            maxHeight = std::max(maxHeight, glyph.Height);
+        }
+
+        //glyph's bitmap, only it's position is recorded
+        if (StartsWith(line, lineEnd, "BITMAP") && !glyphs.empty())
+            glyphs.back().BitmapOffset = lineEnd + 1 - file.Data;
+
+        line = lineEnd + 1;
+    }
+
+    //glyphs without an encoding can't be drawn
+    std::erase_if(glyphs, [](BdfGlyph& glyph) { return glyph.Codepoint < 0; });
+    std::sort(glyphs.begin(), glyphs.end(), [](const BdfGlyph& glyph1, const BdfGlyph& glyph2) { return glyph1.Codepoint < glyph2.Codepoint; });
+
+    return glyphs;
+}
+
+//returns encoding ranges of glyphs sorted by encoding, glyph indices are relative to 'glyphs'
+std::vector<std::tuple<unsigned int, unsigned int, size_t>> GetEncodingRanges(const std::vector<BdfGlyph>& glyphs)
+{
+    std::vector<std::tuple<unsigned int, unsigned int, size_t>> ranges;
+    for (size_t i = 0; i < glyphs.size(); i++)
+    {
+        unsigned int codepoint = glyphs[i].Codepoint;
+        if (i == 0 || codepoint != get<1>(ranges.back()) + 1)
+            ranges.push_back({ codepoint, codepoint, i });
+        else
+            get<1>(ranges.back()) = codepoint;
+    }
+    return ranges;
+}
+
+//returns glyph's coverage (or signed distance field if 'sdfScale' isn't zero), one byte per pixel, top row first
+std::vector<unsigned char> RasterizeBdfGlyph(const MappedFile& file, const BdfGlyph& glyph, unsigned int sdfScale)
+{
+    std::vector<unsigned char> coverage(glyph.Width * glyph.Height);
+    DecodeBdfBitmap<unsigned char>(file, glyph, coverage.data() + glyph.Width * glyph.BitmapY + glyph.BitmapX, glyph.Width, CoverageExpansionTable);
+
+    if (sdfScale == 0)
+        return coverage;
+
+    return GenerateDistanceField(coverage.data(), glyph.Width, glyph.Height, sdfScale, SDF_SPREAD);
+}
+
+//returns bytes which are the same for glyphs with identical pixels, so duplicates can share a single rect of the block
+//bits past the bitmap's width are ignored, blank glyphs only differ by their cell size
+std::string GetBdfGlyphKey(const MappedFile& file, const BdfGlyph& glyph)
+{
+    const char* row = file.Data + glyph.BitmapOffset;
+    const char* fileEnd = file.Data + file.Size;
+    unsigned int rowBytes = (glyph.BitmapWidth + 7) / 8;
+
+    std::string bitmap;
+    bool isBlank = true;
+    for (unsigned int y = 0; y < glyph.BitmapHeight; y++)
+    {
+        const char* rowEnd = static_cast<const char*>(std::memchr(row, '\n', fileEnd - row));
+        if (rowEnd == NULL)
+            rowEnd = fileEnd;
+
+        if (rowEnd - row < rowBytes * 2)
+            throw std::runtime_error("Glyph's bitmap row is too short.");
+
+        for (unsigned int i = 0; i < rowBytes; i++)
+        {
+            unsigned char byte = HexDigitValues[static_cast<unsigned char>(row[i * 2])] << 4 | HexDigitValues[static_cast<unsigned char>(row[i * 2 + 1])];
+            byte &= 0xFF << (8 - std::min(8u, glyph.BitmapWidth - i * 8));
+            bitmap += static_cast<char>(byte);
+            isBlank = isBlank && byte == 0;
+        }
+
+        row = rowEnd + 1;
+    }
+
+    std::string key = std::format("{} {}", glyph.Width, glyph.Height);
+    if (!isBlank)
+        key += std::format(" {} {} {} {} ", glyph.BitmapX, glyph.BitmapY, glyph.BitmapWidth, glyph.BitmapHeight) + bitmap;
+    return key;
+}
+
+//parses a BDF file & rasterizes it's glyphs into a block, glyphs are decoded on all hardware threads
+//glyphs with identical pixels (e.g. blank ones) are rasterized once & share a single rect
+void BuildFontBlock(std::filesystem::path path, unsigned int sdfScale, FontBlock& block)
+{
+    MappedFile file = MappedFile(path);
+    std::vector<BdfGlyph> glyphs = ParseBdfGlyphs(file, block.MaxWidth, block.MaxHeight);
+
+    if (sdfScale != 0)
+    {
+        block.Scale = sdfScale;
+        block.Padding = SDF_SPREAD;
+    }
+
+    //finding duplicates, each glyph is mapped to the first one with the same pixels
+    std::vector<std::string> keys(glyphs.size());
+    ParallelFor(glyphs.size(), [&](size_t i)
+    {
+        keys[i] = GetBdfGlyphKey(file, glyphs[i]);
+    });
+
+    std::unordered_map<std::string_view, size_t> firstGlyphs;
+    std::vector<size_t> originals(glyphs.size());
+    for (size_t i = 0; i < glyphs.size(); i++)
+    {
+        originals[i] = firstGlyphs.try_emplace(keys[i], i).first->second;
+    }
+
+    //packing glyph rects into the block
+    //'Rect' data is used for storing glyph's index
+    RectanglePacker packer;
+    for (size_t i = 0; i < glyphs.size(); i++)
+    {
+        if (originals[i] != i)
+            continue;
+
+        unsigned int width = glyphs[i].Width * block.Scale + 2 * block.Padding;
+        unsigned int height = glyphs[i].Height * block.Scale + 2 * block.Padding;
+        packer.Rects.push_back({ .Width = width, .Height = height, .Data = { static_cast<long>(i), 0, 0, 0 } });
+    }
+
+    packer.Pack();
+    block.Width = packer.TotalWidth;
+    block.Height = packer.TotalHeight;
+    block.PixelStorage.assign(static_cast<size_t>(block.Width) * block.Height, 0);
+    block.Pixels = block.PixelStorage.data();
+
+    block.GlyphRects.resize(glyphs.size());
+    for (Rect rect : packer.Rects)
+    {
+        block.GlyphRects[get<0>(rect.Data)] = rect;
+    }
+    for (size_t i = 0; i < glyphs.size(); i++)
+    {
+        block.GlyphRects[i] = block.GlyphRects[originals[i]];
+    }
+
+    //rasterizing glyphs, rects don't overlap so it's done in parallel
+    ParallelFor(glyphs.size(), [&](size_t i)
+    {
+        if (originals[i] != i)
+            return;
+
+        const BdfGlyph& glyph = glyphs[i];
+        Rect rect = block.GlyphRects[i];
+
+        //block rows go from bottom to top, so the glyph is decoded upside down
+        unsigned char* topRow = block.PixelStorage.data() + static_cast<size_t>(block.Width) * (rect.Y + rect.Height - 1) + rect.X;
+
+        if (sdfScale == 0)
+        {
+            DecodeBdfBitmap<unsigned char>(file, glyph, topRow - static_cast<size_t>(block.Width) * glyph.BitmapY + glyph.BitmapX, -static_cast<ptrdiff_t>(block.Width), CoverageExpansionTable);
+            return;
+        }
+
+        std::vector<unsigned char> distances = RasterizeBdfGlyph(file, glyph, sdfScale);
+        for (unsigned int y = 0; y < rect.Height; y++)
+        {
+            std::memcpy(topRow - static_cast<size_t>(block.Width) * y, distances.data() + static_cast<size_t>(rect.Width) * y, rect.Width);
+        }
+    });
+
+    block.EncodingRanges = GetEncodingRanges(glyphs);
+}
+
+//binary font cache
+//format: header, encoding ranges (3 uints each), glyph rects (4 uints each), block pixels
+
+struct FontCacheHeader
+{
+    char Magic[4] = { 'O', 'G', 'L', 'F' };
+    unsigned int Version = FONT_CACHE_VERSION;
+
+    //source file's key
+    unsigned long long SourceSize = 0;
+    long long SourceTime = 0;
+    unsigned long long SourceHash = 0;
+
+    unsigned int SdfScale = 0;
+    unsigned int MaxWidth = 0;
+    unsigned int MaxHeight = 0;
+    unsigned int Scale = 0;
+    unsigned int Padding = 0;
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+    unsigned int RangeCount = 0;
+    unsigned int GlyphCount = 0;
+};
+
+//64 bit FNV-1a
+unsigned long long HashFile(std::filesystem::path path)
+{
+    MappedFile file = MappedFile(path);
+    unsigned long long hash = 0xCBF29CE484222325;
+    for (size_t i = 0; i < file.Size; i++)
+    {
+        hash = (hash ^ static_cast<unsigned char>(file.Data[i])) * 0x100000001B3;
+    }
+    return hash;
+}
+
+std::filesystem::path GetFontCachePath(std::filesystem::path path, unsigned int sdfScale)
+{
+    std::string suffix = sdfScale == 0 ? "" : std::format(".sdf{}", sdfScale);
+    return std::filesystem::path(path.string() + suffix + FONT_CACHE_EXT);
+}
+
+//returns true if a valid cache of the font exists, in which case 'block' will point into the mapped cache
+//cache is valid if the source file has the same size and modification time or, failing that, the same hash
+bool ReadFontCache(std::filesystem::path path, unsigned int sdfScale, FontBlock& block)
+{
+    std::filesystem::path cachePath = GetFontCachePath(path, sdfScale);
+    if (!std::filesystem::exists(cachePath))
+        return false;
+
+    std::unique_ptr<MappedFile> cache = std::make_unique<MappedFile>(cachePath);
+    if (cache->Size < sizeof(FontCacheHeader))
+        return false;
+
+    FontCacheHeader header;
+    std::memcpy(&header, cache->Data, sizeof(FontCacheHeader));
+    if (std::memcmp(header.Magic, FontCacheHeader().Magic, 4) != 0 || header.Version != FONT_CACHE_VERSION || header.SdfScale != sdfScale)
+        return false;
+
+    size_t rangesSize = header.RangeCount * 3 * sizeof(unsigned int);
+    size_t rectsSize = header.GlyphCount * 4 * sizeof(unsigned int);
+    size_t pixelsSize = static_cast<size_t>(header.Width) * header.Height;
+    if (cache->Size != sizeof(FontCacheHeader) + rangesSize + rectsSize + pixelsSize)
+        return false;
+
+    bool keyMatches = header.SourceSize == std::filesystem::file_size(path) && header.SourceTime == std::filesystem::last_write_time(path).time_since_epoch().count();
+    if (!keyMatches && header.SourceHash != HashFile(path))
+        return false;
+
+    block.MaxWidth = header.MaxWidth;
+    block.MaxHeight = header.MaxHeight;
+    block.Scale = header.Scale;
+    block.Padding = header.Padding;
+    block.Width = header.Width;
+    block.Height = header.Height;
+
+    const unsigned int* ranges = reinterpret_cast<const unsigned int*>(cache->Data + sizeof(FontCacheHeader));
+    for (unsigned int i = 0; i < header.RangeCount; i++)
+    {
+        block.EncodingRanges.push_back({ ranges[i * 3], ranges[i * 3 + 1], ranges[i * 3 + 2] });
+    }
+
+    const unsigned int* rects = ranges + header.RangeCount * 3;
+    for (unsigned int i = 0; i < header.GlyphCount; i++)
+    {
+        block.GlyphRects.push_back({ rects[i * 4], rects[i * 4 + 1], rects[i * 4 + 2], rects[i * 4 + 3] });
+    }
+
+    block.Pixels = reinterpret_cast<const unsigned char*>(rects + header.GlyphCount * 4);
+    block.Cache = std::move(cache);
+    return true;
+}
+
+//failing to write the cache isn't an error, the font will just be parsed again next time
+void WriteFontCache(std::filesystem::path path, unsigned int sdfScale, const FontBlock& block)
+{
+    FontCacheHeader header;
+    header.SourceSize = std::filesystem::file_size(path);
+    header.SourceTime = std::filesystem::last_write_time(path).time_since_epoch().count();
+    header.SourceHash = HashFile(path);
+    header.SdfScale = sdfScale;
+    header.MaxWidth = block.MaxWidth;
+    header.MaxHeight = block.MaxHeight;
+    header.Scale = block.Scale;
+    header.Padding = block.Padding;
+    header.Width = block.Width;
+    header.Height = block.Height;
+    header.RangeCount = block.EncodingRanges.size();
+    header.GlyphCount = block.GlyphRects.size();
+
+    std::vector<unsigned int> ranges;
+    for (auto [startCodepoint, endCodepoint, startIndex] : block.EncodingRanges)
+    {
+        ranges.insert(ranges.end(), { startCodepoint, endCodepoint, static_cast<unsigned int>(startIndex) });
+    }
+
+    std::vector<unsigned int> rects;
+    for (Rect rect : block.GlyphRects)
+    {
+        rects.insert(rects.end(), { rect.X, rect.Y, rect.Width, rect.Height });
+    }
+
+    std::filesystem::path cachePath = GetFontCachePath(path, sdfScale);
+    std::ofstream file = std::ofstream(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(FontCacheHeader));
+    file.write(reinterpret_cast<const char*>(ranges.data()), ranges.size() * sizeof(unsigned int));
+    file.write(reinterpret_cast<const char*>(rects.data()), rects.size() * sizeof(unsigned int));
+    file.write(reinterpret_cast<const char*>(block.Pixels), static_cast<size_t>(block.Width) * block.Height);
+
+    if (!file.good())
+    {
+        Ogl::Log(std::format("Failed to write font cache '{}'.\n", cachePath.string()));
+        file.close();
+        std::filesystem::remove(cachePath);
+    }
+}
+
+//barebones BDF font loader
+//if 'sdfScale' isn't zero then glyphs are upscaled by it & converted to signed distance fields
+//such fonts stay crisp at any scale, so a single font can be used for every text size
+//if 'useCache' is set then rasterized glyphs are stored in a binary cache next to the font file & loaded from it next time,
+//cache is rebuilt automatically once the font file changes
+Ogl::BitmapFont& Ogl::LoadBdfFont(std::filesystem::path path, unsigned int sdfScale, bool useCache)
+{
+    if (GlyphAtlas.Name == 0)
+        InitializeAtlas(GlyphAtlas);
+
+    if (!std::filesystem::exists(path))
+        throw std::runtime_error(std::format("Invalid font path: '{}'.", path.string()));
+
+    FontBlock block;
+    if (!useCache || !ReadFontCache(path, sdfScale, block))
+    {
+        BuildFontBlock(path, sdfScale, block);
+        if (useCache)
+            WriteFontCache(path, sdfScale, block);
+    }
+
+    //placing the whole block into glyph atlas, both store rows from bottom to top
+    std::vector<Rect> blockRects = { { .Width = block.Width, .Height = block.Height } };
+    PackAtlas(GlyphAtlas, blockRects);
+    Rect blockRect = blockRects[0];
+
+    WriteToAtlas(GlyphAtlas, blockRect.Page, const_cast<unsigned char*>(block.Pixels), blockRect.X, blockRect.Y, block.Width, block.Height, false);
+    GlyphAtlas.Pages[blockRect.Page].DirtyRects.push_back(blockRect);
+
+    BitmapFont result = {};
+    result.Path = path;
+    result.MaxWidth = block.MaxWidth;
+    result.MaxHeight = block.MaxHeight;
+    result.Scale = block.Scale;
+    result.Padding = block.Padding;
+    result.GlyphCount = block.GlyphRects.size();
+
+    for (auto [startCodepoint, endCodepoint, startIndex] : block.EncodingRanges)
+    {
+        result.EncodingRanges.push_back({ startCodepoint, endCodepoint, startIndex + TextureDimensionsVector.size() });
+    }
+
+    for (Rect rect : block.GlyphRects)
+    {
+        rect.X += blockRect.X;
+        rect.Y += blockRect.Y;
+        rect.Page = blockRect.Page;
+        AddTexture(rect, TEXTURE_FLAG_GLYPH | (sdfScale != 0 ? TEXTURE_FLAG_SDF : 0));
+    }
+
+    UpdateTextureData();
+    UploadAtlas(GlyphAtlas);
+    Fonts.push_back(result);
+    return Fonts.back();
+}
+
+//glyphs of a lazy font, the font file stays mapped & glyphs are rasterized into cells of a reserved atlas region on first use
+//once all cells are taken the least recently used glyph is evicted, if all of them were used during the current frame another region is reserved
+struct Ogl::LazyGlyphCache
+{
+    std::unique_ptr<MappedFile> File;
+    std::vector<BdfGlyph> Glyphs; //sorted by encoding
+    unsigned int SdfScale = 0;
+
+    std::vector<Rect> Regions; //reserved atlas regions of the same size, each split into cells fitting the largest glyph
+    unsigned int CellWidth = 0;
+    unsigned int CellHeight = 0;
+    unsigned int Columns = 0;
+    unsigned int Rows = 0;
+
+    std::vector<size_t> CellTextures; //each cell has a texture of it's own, it's dimensions are updated after loading a glyph into the cell
+    std::vector<size_t> CellGlyphs; //index of the glyph stored in the cell or -1 if it's empty
+    std::vector<size_t> CellLastUsed; //value of 'FrameIndex' at the time of the cell's last use
+    std::vector<std::list<size_t>::iterator> CellPositions; //positions of cells in 'RecentCells'
+    std::list<size_t> RecentCells; //from the most recently used to the least recently used, empty cells come last
+    std::unordered_map<size_t, size_t> GlyphCells; //glyph index, cell index
+    size_t EvictionCount = 0;
+
+    size_t GetGlyphTexture(size_t glyphIndex);
+    void LoadGlyph(size_t glyphIndex, size_t cell);
+    void AddRegion();
+    Rect GetCellRect(size_t cell);
+};
+
+//returns index of the glyph's texture, loading the glyph if it's not in atlas
+size_t Ogl::LazyGlyphCache::GetGlyphTexture(size_t glyphIndex)
+{
+    size_t cell;
+    auto glyphCell = GlyphCells.find(glyphIndex);
+    if (glyphCell != GlyphCells.end())
+    {
+        cell = glyphCell->second;
+    }
+    else
+    {
+        //glyphs used during the current frame could've been already drawn, so they can't be evicted
+        cell = RecentCells.back();
+        if (CellGlyphs[cell] != -1 && CellLastUsed[cell] == FrameIndex)
+        {
+            AddRegion();
+            cell = RecentCells.back();
+        }
+
+        if (CellGlyphs[cell] != -1)
+        {
+            GlyphCells.erase(CellGlyphs[cell]);
+            EvictionCount++;
+        }
+
+        LoadGlyph(glyphIndex, cell);
+    }
+
+    RecentCells.splice(RecentCells.begin(), RecentCells, CellPositions[cell]);
+    CellLastUsed[cell] = FrameIndex;
+    return CellTextures[cell];
+}
+
+//rasterizes the glyph into the cell & sends the cell and it's texture's new dimensions to GPU
+void Ogl::LazyGlyphCache::LoadGlyph(size_t glyphIndex, size_t cell)
+{
+    const BdfGlyph& glyph = Glyphs[glyphIndex];
+    std::vector<unsigned char> pixels = RasterizeBdfGlyph(*File, glyph, SdfScale);
+
+    unsigned int padding = SdfScale != 0 ? SDF_SPREAD : 0;
+    unsigned int scale = SdfScale != 0 ? SdfScale : 1;
+    unsigned int width = glyph.Width * scale + 2 * padding;
+    unsigned int height = glyph.Height * scale + 2 * padding;
+    Rect cellRect = GetCellRect(cell);
+
+    WriteToAtlas(GlyphAtlas, cellRect.Page, pixels.data(), cellRect.X, cellRect.Y, width, height);
+    GlyphAtlas.Pages[cellRect.Page].DirtyRects.push_back({ cellRect.X, cellRect.Y, width, height });
+    UploadAtlas(GlyphAtlas);
+
+    size_t texture = CellTextures[cell];
+    TextureDimensionsVector[texture].Width = width;
+    TextureDimensionsVector[texture].Height = height;
+    TextureDimensionsVector[texture].SourceWidth = width;
+    TextureDimensionsVector[texture].SourceHeight = height;
+    TexturesToUpdate.push_back(texture);
+    UpdateTextureData();
+
+    CellGlyphs[cell] = glyphIndex;
+    GlyphCells[glyphIndex] = cell;
+}
+
+//reserves another region of empty cells, they're placed at the end of 'RecentCells' so they're taken first
+void Ogl::LazyGlyphCache::AddRegion()
+{
+    std::vector<Rect> regions = { { .Width = Columns * CellWidth, .Height = Rows * CellHeight } };
+    PackAtlas(GlyphAtlas, regions);
+    Regions.push_back(regions[0]);
+
+    unsigned int flags = TEXTURE_FLAG_GLYPH | (SdfScale != 0 ? TEXTURE_FLAG_SDF : 0);
+    for (size_t i = 0; i < static_cast<size_t>(Columns) * Rows; i++)
+    {
+        size_t cell = CellTextures.size();
+        CellTextures.push_back(AddTexture(GetCellRect(cell), flags).Index);
+        CellGlyphs.push_back(-1);
+        CellLastUsed.push_back(0);
+        CellPositions.push_back(RecentCells.insert(RecentCells.end(), cell));
+    }
+
+    UpdateTextureData();
+    UploadAtlas(GlyphAtlas);
+    if (Regions.size() > 1)
+        Log(std::format("Lazy font's cache has been expanded to {} glyphs.\n", CellTextures.size()));
+}
+
+//returns position of the cell in atlas, with the size of an empty glyph
+Rect Ogl::LazyGlyphCache::GetCellRect(size_t cell)
+{
+    Rect region = Regions[cell / (static_cast<size_t>(Columns) * Rows)];
+    unsigned int index = static_cast<unsigned int>(cell % (static_cast<size_t>(Columns) * Rows));
+    return { .X = region.X + index % Columns * CellWidth, .Y = region.Y + index / Columns * CellHeight, .Page = region.Page };
+}
+
+//same as 'LoadBdfFont', but only indexes the font file, glyphs are rasterized when they're first drawn
+//'capacity' glyphs fit into atlas at once, after that least recently used glyphs are evicted to make room for new ones
+//if a single frame uses more glyphs than that, the font reserves more atlas space instead of evicting them
+//meant for large fonts (e.g. CJK/unifont) of which only a small set of characters is actually displayed
+//NOTE: since evicted glyphs' textures are reused, text drawn with a lazy font should be redrawn once 'GetEvictionCount' changes
+Ogl::BitmapFont& Ogl::LoadBdfFontLazy(std::filesystem::path path, unsigned int sdfScale, size_t capacity)
+{
+    if (GlyphAtlas.Name == 0)
+        InitializeAtlas(GlyphAtlas);
+
+    if (!std::filesystem::exists(path))
+        throw std::runtime_error(std::format("Invalid font path: '{}'.", path.string()));
+
+    if (capacity == 0)
+        throw std::runtime_error("Lazy font's capacity must be greater than zero.");
+
+    std::shared_ptr<LazyGlyphCache> cache = std::make_shared<LazyGlyphCache>();
+    cache->File = std::make_unique<MappedFile>(path);
+    cache->SdfScale = sdfScale;
+
+    BitmapFont result = {};
+    result.Path = path;
+    result.MaxWidth = 0;
+    result.MaxHeight = 0;
+    cache->Glyphs = ParseBdfGlyphs(*cache->File, result.MaxWidth, result.MaxHeight);
+    result.EncodingRanges = GetEncodingRanges(cache->Glyphs);
+    result.GlyphCount = cache->Glyphs.size();
+
+    if (sdfScale != 0)
+    {
+        result.Scale = sdfScale;
+        result.Padding = SDF_SPREAD;
+    }
+
+    //reserving a roughly square region of cells
+    capacity = std::min(capacity, std::max(result.GlyphCount, static_cast<size_t>(1)));
+    cache->CellWidth = result.MaxWidth * result.Scale + 2 * result.Padding;
+    cache->CellHeight = result.MaxHeight * result.Scale + 2 * result.Padding;
+    cache->Columns = std::max(static_cast<unsigned int>(std::sqrt(static_cast<double>(capacity) * cache->CellHeight / std::max(cache->CellWidth, 1u))), 1u);
+    cache->Rows = static_cast<unsigned int>((capacity + cache->Columns - 1) / cache->Columns);
+    cache->AddRegion();
+
+    result.Lazy = cache;
+    Fonts.push_back(result);
+    return Fonts.back();
+}
+
+//glyphs of a TrueType font rasterized so far, keyed by glyph id & pixel size
+//glyphs are rasterized into atlas on demand, missing glyphs of a whole string are rasterized at once on all hardware threads
+//fonts are parsed & rasterized by stb_truetype, so both 'glyf' & CFF outlines are supported, hinting is ignored
+struct Ogl::TrueTypeGlyphCache
+{
+    std::filesystem::path Path;
+    std::unique_ptr<MappedFile> File; //stb_truetype reads the font straight from memory, so the file stays mapped for the lifetime of the cache
+    stbtt_fontinfo Info = {};
+    int Ascender = 0; //in font units, relative to the baseline
+    int Descender = 0;
+    unsigned int MaxAdvance = 0;
+    std::unordered_map<unsigned long long, size_t> GlyphTextures; //glyph id in the high half & pixel size in the low one, texture index
+
+    TrueTypeGlyphCache(std::filesystem::path path);
+
+    unsigned int GetGlyphId(unsigned int codepoint) const;
+    std::tuple<unsigned int, unsigned int> GetLineMetrics(unsigned int pixelSize) const;
+    size_t GetGlyphTexture(unsigned int glyphId, unsigned int pixelSize);
+    void LoadGlyphs(std::vector<unsigned int> glyphIds, unsigned int pixelSize);
+};
+
+//faces are kept alive for as long as their glyphs are in atlas
+std::vector<std::shared_ptr<Ogl::TrueTypeGlyphCache>> TrueTypeFaces;
+
+unsigned long long GetTrueTypeGlyphKey(unsigned int glyphId, unsigned int pixelSize)
+{
+    return static_cast<unsigned long long>(glyphId) << 32 | pixelSize;
+}
+
+Ogl::TrueTypeGlyphCache::TrueTypeGlyphCache(std::filesystem::path path) : Path(path)
+{
+    File = std::make_unique<MappedFile>(path);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(File->Data);
+
+    int offset = stbtt_GetFontOffsetForIndex(data, 0);
+    if (offset < 0 || !stbtt_InitFont(&Info, data, offset))
+        throw std::runtime_error(std::format("Invalid TrueType font: '{}'.", path.string()));
+
+    stbtt_GetFontVMetrics(&Info, &Ascender, &Descender, NULL);
+
+    //stb_truetype doesn't expose 'advanceWidthMax' of the 'hhea' table
+    MaxAdvance = data[Info.hhea + 10] << 8 | data[Info.hhea + 11];
+}
+
+//returns 0 if the codepoint is unsupported by font
+unsigned int Ogl::TrueTypeGlyphCache::GetGlyphId(unsigned int codepoint) const
+{
+    return stbtt_FindGlyphIndex(&Info, static_cast<int>(codepoint));
+}
+
+//returns distance from the top of the line to the baseline & line's height, in pixels
+std::tuple<unsigned int, unsigned int> Ogl::TrueTypeGlyphCache::GetLineMetrics(unsigned int pixelSize) const
+{
+    float scale = stbtt_ScaleForMappingEmToPixels(&Info, static_cast<float>(pixelSize));
+    unsigned int ascent = static_cast<unsigned int>(std::max(std::ceil(Ascender * scale), 0.0f));
+    unsigned int descent = static_cast<unsigned int>(std::max(std::ceil(-Descender * scale), 0.0f));
+    return { ascent, ascent + descent };
+}
+
+size_t Ogl::TrueTypeGlyphCache::GetGlyphTexture(unsigned int glyphId, unsigned int pixelSize)
+{
+    auto texture = GlyphTextures.find(GetTrueTypeGlyphKey(glyphId, pixelSize));
+    if (texture != GlyphTextures.end())
+        return texture->second;
+
+    LoadGlyphs({ glyphId }, pixelSize);
+    return GlyphTextures[GetTrueTypeGlyphKey(glyphId, pixelSize)];
+}
+
+//rasterizes glyphs which aren't in atlas yet & sends them to GPU at once
+//each glyph fills a cell as wide as it's advance & as high as the line with the baseline at the same height, so glyphs can be drawn just like bitmap ones
+//(parts of glyphs overhanging their cells, e.g. of italic ones, are clipped)
+void Ogl::TrueTypeGlyphCache::LoadGlyphs(std::vector<unsigned int> glyphIds, unsigned int pixelSize)
+{
+    std::sort(glyphIds.begin(), glyphIds.end());
+    glyphIds.erase(std::unique(glyphIds.begin(), glyphIds.end()), glyphIds.end());
+    std::erase_if(glyphIds, [&](unsigned int glyphId) { return GlyphTextures.contains(GetTrueTypeGlyphKey(glyphId, pixelSize)); });
+    if (glyphIds.empty())
+        return;
+
+    float scale = stbtt_ScaleForMappingEmToPixels(&Info, static_cast<float>(pixelSize));
+    auto [ascent, height] = GetLineMetrics(pixelSize);
+
+    //stb_truetype only reads the font, so glyphs can be rasterized concurrently
+    std::vector<unsigned int> widths(glyphIds.size());
+    std::vector<std::vector<unsigned char>> glyphPixels(glyphIds.size());
+    ParallelFor(glyphIds.size(), [&](size_t i)
+    {
+        int glyphId = static_cast<int>(glyphIds[i]);
+        int advance, bearing;
+        stbtt_GetGlyphHMetrics(&Info, glyphId, &advance, &bearing);
+        widths[i] = static_cast<unsigned int>(std::max(std::round(advance * scale), 0.0f));
+        glyphPixels[i].resize(static_cast<size_t>(widths[i]) * height);
+
+        //glyph's bounding box relative to the origin on the baseline, y axis points down
+        int x0, y0, x1, y1;
+        stbtt_GetGlyphBitmapBox(&Info, glyphId, scale, scale, &x0, &y0, &x1, &y1);
+        if (x1 <= x0 || y1 <= y0)
+            return;
+
+        std::vector<unsigned char> bitmap(static_cast<size_t>(x1 - x0) * (y1 - y0));
+        stbtt_MakeGlyphBitmap(&Info, bitmap.data(), x1 - x0, y1 - y0, x1 - x0, scale, scale, glyphId);
+
+        //copying the part of the bitmap inside of the cell
+        int top = static_cast<int>(ascent) + y0;
+        for (int y = std::max(top, 0); y < std::min(top + y1 - y0, static_cast<int>(height)); y++)
+        {
+            for (int x = std::max(x0, 0); x < std::min(x1, static_cast<int>(widths[i])); x++)
+            {
+                glyphPixels[i][static_cast<size_t>(y) * widths[i] + x] = bitmap[static_cast<size_t>(y - top) * (x1 - x0) + (x - x0)];
+            }
+        }
+    });
+
+    //packing glyph cells, empty ones don't take any space
+    std::vector<Rect> rects;
+    for (size_t i = 0; i < glyphIds.size(); i++)
+    {
+        rects.push_back({ .Width = widths[i], .Height = height });
+    }
+    PackAtlas(GlyphAtlas, rects);
+
+    for (size_t i = 0; i < glyphIds.size(); i++)
+    {
+        if (rects[i].Width != 0 && rects[i].Height != 0)
+        {
+            WriteToAtlas(GlyphAtlas, rects[i].Page, glyphPixels[i].data(), rects[i].X, rects[i].Y, rects[i].Width, rects[i].Height);
+            GlyphAtlas.Pages[rects[i].Page].DirtyRects.push_back(rects[i]);
+        }
+
+        GlyphTextures[GetTrueTypeGlyphKey(glyphIds[i], pixelSize)] = AddTexture(rects[i], TEXTURE_FLAG_GLYPH).Index;
+    }
+
+    UpdateTextureData();
+    UploadAtlas(GlyphAtlas);
+}
+
+//loads a TrueType font of the specified size (in pixels per em), glyphs are rasterized into atlas when they're first drawn
+//loading the same font in different sizes is cheap, the file is parsed only once & glyphs are cached for each size separately
+Ogl::BitmapFont& Ogl::LoadTrueTypeFont(std::filesystem::path path, unsigned int pixelSize)
+{
+    if (GlyphAtlas.Name == 0)
+        InitializeAtlas(GlyphAtlas);
+
+    if (!std::filesystem::exists(path))
+        throw std::runtime_error(std::format("Invalid font path: '{}'.", path.string()));
+
+    if (pixelSize == 0)
+        throw std::runtime_error("Font size must be greater than zero.");
+
+    auto face = std::find_if(TrueTypeFaces.begin(), TrueTypeFaces.end(),
+        [&](const std::shared_ptr<TrueTypeGlyphCache>& face) { return std::filesystem::equivalent(face->Path, path); });
+
+    std::shared_ptr<TrueTypeGlyphCache> cache = face != TrueTypeFaces.end() ? *face : TrueTypeFaces.emplace_back(std::make_shared<TrueTypeGlyphCache>(path));
+
+    BitmapFont result = {};
+    result.Path = path;
+    result.TrueType = cache;
+    result.PixelSize = pixelSize;
+    result.MaxWidth = static_cast<unsigned int>(std::ceil(cache->MaxAdvance * stbtt_ScaleForMappingEmToPixels(&cache->Info, static_cast<float>(pixelSize))));
+    result.MaxHeight = get<1>(cache->GetLineMetrics(pixelSize));
+    result.GlyphCount = cache->Info.numGlyphs;
+
+    //printable ascii is rasterized upfront
+    std::basic_string<unsigned int> ascii;
+    for (unsigned int codepoint = ' '; codepoint <= '~'; codepoint++)
+    {
+        ascii.push_back(codepoint);
+    }
+    result.PrepareGlyphs(ascii);
+
+    Fonts.push_back(result);
+    return Fonts.back();
+}
+
+//returns index of the glyph's texture or -1 if the codepoint is unsupported by font
+//glyphs of lazy fonts are loaded by this method, so the index is only valid until the glyph gets evicted
+size_t Ogl::BitmapFont::GetGlyphIndex(unsigned int codepoint) const
+{
+    if (TrueType)
+    {
+        unsigned int glyphId = TrueType->GetGlyphId(codepoint);
+        return glyphId == 0 ? -1 : TrueType->GetGlyphTexture(glyphId, PixelSize);
+    }
+
+    //ranges are sorted by their first codepoint
+    auto range = std::upper_bound(EncodingRanges.begin(), EncodingRanges.end(), codepoint,
+        [](unsigned int codepoint, const std::tuple<unsigned int, unsigned int, size_t>& range) { return codepoint < get<0>(range); });
+
+    if (range == EncodingRanges.begin())
+        return -1;
+
+    auto& [startCodepoint, endCodepoint, startIndex] = *(range - 1);
+    if (codepoint > endCodepoint)
+        return -1;
+
+    size_t glyphIndex = startIndex + codepoint - startCodepoint;
+    return Lazy ? Lazy->GetGlyphTexture(glyphIndex) : glyphIndex;
+}
+
+//rasterizes all of the text's glyphs missing from atlas at once, should be called before drawing the text with 'GetGlyphIndex'
+//does nothing for bitmap fonts
+void Ogl::BitmapFont::PrepareGlyphs(const std::basic_string<unsigned int>& text) const
+{
+    if (!TrueType)
+        return;
+
+    std::vector<unsigned int> glyphIds;
+    for (unsigned int codepoint : text)
+    {
+        unsigned int glyphId = TrueType->GetGlyphId(codepoint);
+        if (glyphId != 0)
+            glyphIds.push_back(glyphId);
+    }
+
+    TrueType->LoadGlyphs(glyphIds, PixelSize);
+}
+
+//number of glyphs evicted by a lazy font so far, text drawn with the font before the last eviction may display wrong glyphs
+size_t Ogl::BitmapFont::GetEvictionCount() const
+{
+    return Lazy ? Lazy->EvictionCount : 0;
+}
+
+//finds font by path if it's already loaded/loads it if not
+Ogl::BitmapFont& Ogl::ResolveFont(std::filesystem::path path)
+{
+    size_t index = FontRegistry.Find(path);
+    if (index == -1)
+    {
+        LoadBdfFont(path);
+        index = Fonts.size() - 1;
+        FontRegistry.Add(path, index);
+    }
+
+    return Fonts[index];
+}
@@ -0,0 +1,265 @@
+#include <format>
+#include <stdexcept>
+#include <json.hpp>
+
+//returns NULL if the value isn't an object or doesn't have the key
+const JsonValue* JsonValue::Find(std::string_view key) const
+{
+    for (const auto& [name, value] : Object)
+    {
+        if (name == key)
+            return &value;
+    }
+    return NULL;
+}
+
+//same as 'Find', but throws if the key is missing
+const JsonValue& JsonValue::Get(std::string_view key) const
+{
+    const JsonValue* value = Find(key);
+    if (value == NULL)
+        throw std::runtime_error(std::format("JSON value doesn't have a '{}' key.", key));
+    return *value;
+}
+
+//returns 'fallback' if the key is missing, throws if it isn't a number
+double JsonValue::GetNumber(std::string_view key, double fallback) const
+{
+    const JsonValue* value = Find(key);
+    if (value == NULL)
+        return fallback;
+
+    if (value->Kind != Type::Number)
+        throw std::runtime_error(std::format("JSON value '{}' isn't a number.", key));
+    return value->Number;
+}
+
+struct JsonParser
+{
+    std::string_view Text;
+    size_t Position = 0;
+
+    [[noreturn]] void Fail(std::string_view message)
+    {
+        throw std::runtime_error(std::format("Invalid JSON at offset {}: {}.", Position, message));
+    }
+
+    void SkipWhitespace()
+    {
+        while (Position < Text.size() && (Text[Position] == ' ' || Text[Position] == '\t' || Text[Position] == '\n' || Text[Position] == '\r'))
+        {
+            Position++;
+        }
+    }
+
+    char Peek()
+    {
+        SkipWhitespace();
+        if (Position == Text.size())
+            Fail("unexpected end");
+        return Text[Position];
+    }
+
+    void Expect(char c)
+    {
+        if (Peek() != c)
+            Fail(std::format("expected '{}'", c));
+        Position++;
+    }
+
+    bool ConsumeWord(std::string_view word)
+    {
+        if (Text.substr(Position, word.size()) != word)
+            return false;
+        Position += word.size();
+        return true;
+    }
+
+    unsigned int ParseHex()
+    {
+        if (Position + 4 > Text.size())
+            Fail("truncated escape");
+
+        unsigned int result = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            char c = Text[Position++];
+            unsigned int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+            if (digit == 16)
+                Fail("invalid escape");
+            result = result * 16 + digit;
+        }
+        return result;
+    }
+
+    std::string ParseString()
+    {
+        Expect('"');
+        std::string result;
+        while (true)
+        {
+            if (Position == Text.size())
+                Fail("unterminated string");
+
+            char c = Text[Position++];
+            if (c == '"')
+                return result;
+            if (c != '\\')
+            {
+                result += c;
+                continue;
+            }
+
+            if (Position == Text.size())
+                Fail("unterminated string");
+
+            char escape = Text[Position++];
+            switch (escape)
+            {
+            case '"': case '\\': case '/': result += escape; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u':
+            {
+                unsigned int codepoint = ParseHex();
+                if (codepoint >= 0xD800 && codepoint < 0xDC00 && ConsumeWord("\\u")) //surrogate pair
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (ParseHex() - 0xDC00);
+
+                if (codepoint < 0x80)
+                {
+                    result += static_cast<char>(codepoint);
+                }
+                else if (codepoint < 0x800)
+                {
+                    result += static_cast<char>(0xC0 | codepoint >> 6);
+                    result += static_cast<char>(0x80 | (codepoint & 0x3F));
+                }
+                else if (codepoint < 0x10000)
+                {
+                    result += static_cast<char>(0xE0 | codepoint >> 12);
+                    result += static_cast<char>(0x80 | (codepoint >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (codepoint & 0x3F));
+                }
+                else
+                {
+                    result += static_cast<char>(0xF0 | codepoint >> 18);
+                    result += static_cast<char>(0x80 | (codepoint >> 12 & 0x3F));
+                    result += static_cast<char>(0x80 | (codepoint >> 6 & 0x3F));
+                    result += static_cast<char>(0x80 | (codepoint & 0x3F));
+                }
+                break;
+            }
+            default: Fail("invalid escape");
+            }
+        }
+    }
+
+    double ParseNumber()
+    {
+        size_t start = Position;
+        while (Position < Text.size() && std::string_view("+-0123456789.eE").find(Text[Position]) != std::string_view::npos)
+        {
+            Position++;
+        }
+
+        std::string number = std::string(Text.substr(start, Position - start));
+        size_t length = 0;
+        double result = 0.0;
+        try
+        {
+            result = std::stod(number, &length);
+        }
+        catch (const std::exception&)
+        {
+            length = 0;
+        }
+
+        if (length == 0 || length != number.size())
+        {
+            Position = start;
+            Fail("invalid number");
+        }
+        return result;
+    }
+
+    JsonValue ParseValue(unsigned int depth)
+    {
+        if (depth > 256)
+            Fail("nested too deeply");
+
+        JsonValue value;
+        char c = Peek();
+        if (c == '{')
+        {
+            value.Kind = JsonValue::Type::Object;
+            Position++;
+            if (Peek() == '}')
+            {
+                Position++;
+                return value;
+            }
+
+            do
+            {
+                std::string key = ParseString();
+                Expect(':');
+                value.Object.emplace_back(std::move(key), ParseValue(depth + 1));
+            } while (Peek() == ',' && ++Position);
+            Expect('}');
+        }
+        else if (c == '[')
+        {
+            value.Kind = JsonValue::Type::Array;
+            Position++;
+            if (Peek() == ']')
+            {
+                Position++;
+                return value;
+            }
+
+            do
+            {
+                value.Array.push_back(ParseValue(depth + 1));
+            } while (Peek() == ',' && ++Position);
+            Expect(']');
+        }
+        else if (c == '"')
+        {
+            value.Kind = JsonValue::Type::String;
+            value.String = ParseString();
+        }
+        else if (ConsumeWord("true"))
+        {
+            value.Kind = JsonValue::Type::Bool;
+            value.Bool = true;
+        }
+        else if (ConsumeWord("false"))
+        {
+            value.Kind = JsonValue::Type::Bool;
+        }
+        else if (ConsumeWord("null"))
+        {
+            value.Kind = JsonValue::Type::Null;
+        }
+        else
+        {
+            value.Kind = JsonValue::Type::Number;
+            value.Number = ParseNumber();
+        }
+
+        return value;
+    }
+};
+
+JsonValue ParseJson(std::string_view text)
+{
+    JsonParser parser = { .Text = text };
+    JsonValue result = parser.ParseValue(0);
+    parser.SkipWhitespace();
+    if (parser.Position != text.size())
+        parser.Fail("unexpected data after the value");
+    return result;
+}
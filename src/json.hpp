@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//minimal JSON parser for asset descriptions (e.g. sprite sheets), the whole document is parsed into a tree of values
+//numbers are stored as doubles, escaped code points are converted to UTF-8, errors are reported as 'std::runtime_error'
+struct JsonValue
+{
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type Kind = Type::Null;
+    bool Bool = false;
+    double Number = 0.0;
+    std::string String;
+    std::vector<JsonValue> Array;
+    std::vector<std::pair<std::string, JsonValue>> Object; //in document order
+
+    const JsonValue* Find(std::string_view key) const;
+    const JsonValue& Get(std::string_view key) const;
+    double GetNumber(std::string_view key, double fallback) const;
+};
+
+JsonValue ParseJson(std::string_view text);
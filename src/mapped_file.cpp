@@ -0,0 +1,77 @@
+#include <format>
+#include <stdexcept>
+#include <mapped_file.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+
+MappedFile::MappedFile(std::filesystem::path path)
+{
+    FileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (FileHandle == INVALID_HANDLE_VALUE)
+        throw std::runtime_error(std::format("Failed to open file: '{}'.", path.string()));
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(FileHandle, &size);
+    Size = static_cast<size_t>(size.QuadPart);
+    if (Size == 0) //empty files can't be mapped
+        return;
+
+    MappingHandle = CreateFileMappingW(FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (MappingHandle != NULL)
+        Data = static_cast<const char*>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+    if (Data == NULL)
+    {
+        if (MappingHandle != NULL)
+            CloseHandle(MappingHandle);
+        CloseHandle(FileHandle);
+        throw std::runtime_error(std::format("Failed to map file: '{}'.", path.string()));
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (Data != NULL)
+        UnmapViewOfFile(Data);
+    if (MappingHandle != NULL)
+        CloseHandle(MappingHandle);
+    if (FileHandle != NULL && FileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(FileHandle);
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(std::filesystem::path path)
+{
+    FileDescriptor = open(path.c_str(), O_RDONLY);
+    if (FileDescriptor == -1)
+        throw std::runtime_error(std::format("Failed to open file: '{}'.", path.string()));
+
+    struct stat status;
+    fstat(FileDescriptor, &status);
+    Size = static_cast<size_t>(status.st_size);
+    if (Size == 0) //empty files can't be mapped
+        return;
+
+    void* data = mmap(NULL, Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+    if (data == MAP_FAILED)
+    {
+        close(FileDescriptor);
+        throw std::runtime_error(std::format("Failed to map file: '{}'.", path.string()));
+    }
+
+    Data = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (Data != NULL)
+        munmap(const_cast<char*>(Data), Size);
+    if (FileDescriptor != -1)
+        close(FileDescriptor);
+}
+#endif
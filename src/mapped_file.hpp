@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+
+//read-only view of a whole file mapped into memory, unmapped upon destruction
+struct MappedFile
+{
+    const char* Data = NULL;
+    size_t Size = 0;
+
+    #ifdef _WIN32
+    void* FileHandle = NULL;
+    void* MappingHandle = NULL;
+    #else
+    int FileDescriptor = -1;
+    #endif
+
+    MappedFile(std::filesystem::path path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+};
@@ -11,12 +11,15 @@
 #define STBI_FAILURE_USERMSG
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STB_TRUETYPE_IMPLEMENTATION
 #include <stb_image.h>
 #include <stb_image_write.h>
+#include <stb_truetype.h>
 
 #include <mat3.hpp>
 #include <shaders.hpp>
 #include <ogl.hpp>
+#include <atlas.hpp>
 
 void Ogl::Log(std::string msg)
 {
@@ -252,50 +255,25 @@ void Ogl::Initialize(int windowWidth, int windowHeight, std::string windowName,
     glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, VERT_SIZE, reinterpret_cast<void*>(4 * sizeof(float) + sizeof(unsigned int)));
     glEnableVertexAttribArray(3);
 
-    //!! shader compilation !!
-
-    unsigned int vertShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShader, 1, &VertexShaderSource, NULL);
-    glCompileShader(vertShader);
-
-    int success;
-    char msg[256];
-    glGetShaderiv(vertShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertShader, 256, NULL, msg);
-        throw std::runtime_error(std::format("Error while compiling the vertex shader: '{}'.", msg));
-    }
-
-    unsigned int fragShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShader, 1, &FragmentShaderSource, NULL);
-    glCompileShader(fragShader);
-
-    glGetShaderiv(fragShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    //glyph layers use a separate VAO, it's attributes are per instance and point to the layer's block, so they're set before each draw call
+    glGenVertexArrays(1, &GlyphVao);
+    glBindVertexArray(GlyphVao);
+    for (unsigned int i = 0; i < 4; i++)
     {
-        glGetShaderInfoLog(fragShader, 256, NULL, msg);
-        throw std::runtime_error(std::format("Error while compiling the fragment shader: '{}'.", msg));
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
     }
+    glBindVertexArray(Vao);
 
-    unsigned int shaders;
-    shaders = glCreateProgram();
-    glAttachShader(shaders, vertShader);
-    glAttachShader(shaders, fragShader);
-    glLinkProgram(shaders);
-
-    glGetProgramiv(shaders, GL_LINK_STATUS, &success);
-    if(!success)
-    {
-        glGetProgramInfoLog(shaders, 256, NULL, msg);
-        throw std::runtime_error(std::format("Error while linking shaders: '{}'.", msg));
-    }
-    glDeleteShader(vertShader);
-    glDeleteShader(fragShader);
-    glUseProgram(shaders);
+    //!! shader compilation !!
 
-    //shader uniform values
-    UniformNdcMatrix = glGetUniformLocation(shaders, "NDCMatrix");
+    //variants only pay for what layers draw: repeated textures are resolved per fragment, others are mapped to atlas per vertex
+    //after the first launch programs are loaded from the binary cache
+    TiledShader = &GetShader(VertexShaderSource, FragmentShaderSource, { "TEXTURES", "TILING" });
+    TexturedShader = &GetShader(VertexShaderSource, FragmentShaderSource, { "TEXTURES" });
+    ColorShader = &GetShader(VertexShaderSource, FragmentShaderSource);
+    GlyphShader = &GetShader(GlyphVertexShaderSource, FragmentShaderSource, { "TEXTURES" });
+    glUseProgram(TiledShader->Program);
     
     //binding ssbo
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_BINDING, Ssbo.Name);
@@ -310,11 +288,15 @@ void Ogl::UpdateLoop()
     while (!glfwWindowShouldClose(Window)) 
     {
         glClear(GL_COLOR_BUFFER_BIT);
+        UpdateTextureStreaming();
+        UpdateAtlasCompaction();
+        Shader* usedShader = TiledShader;
 
         for (Layer* layer : Layers)
         {
             BufferBlock& layerBlock = Vbo.Blocks[layer->BlockIndex];
             layer->RenderingDataUsed = 0;
+            layer->ShaderFeatures = 0;
             layer->Draw();
 
             if (ClippingEnabled && IsLayerOutOfView(layer))
@@ -344,24 +326,63 @@ void Ogl::UpdateLoop()
                 if (dataSize > 0)
                     glBufferSubData(GL_ARRAY_BUFFER, layerBlock.Offset, dataSize, layer->RenderingData);
 
+                layer->BlockShaderFeatures = layer->ShaderFeatures;
                 layer->Redraw = false;
             }
 
+            //switching to the program matching layer's contents
+            Shader* shader = TiledShader;
+            if (layer->IsGlyphLayer)
+                shader = GlyphShader;
+            else if ((layer->BlockShaderFeatures & SHADER_FEATURE_TEXTURES) == 0)
+                shader = ColorShader;
+            else if ((layer->BlockShaderFeatures & SHADER_FEATURE_TILING) == 0)
+                shader = TexturedShader;
+
+            if (shader != usedShader)
+            {
+                if ((shader == GlyphShader) != (usedShader == GlyphShader))
+                    glBindVertexArray(shader == GlyphShader ? GlyphVao : Vao);
+
+                usedShader = shader;
+                glUseProgram(shader->Program);
+            }
+
             //setting transform matrix
+            int uniformNdcMatrix = shader->GetUniformLocation("NDCMatrix");
             if (layer->IsWorldSpace)
             {
-                glUniformMatrix3fv(UniformNdcMatrix, 1, GL_TRUE, WorldToNDCMatrix.Cells);
+                glUniformMatrix3fv(uniformNdcMatrix, 1, GL_TRUE, WorldToNDCMatrix.Cells);
             }
             else
             {
-                glUniformMatrix3fv(UniformNdcMatrix, 1, GL_TRUE, IDENTITY_MATRIX.Cells);
+                glUniformMatrix3fv(uniformNdcMatrix, 1, GL_TRUE, IDENTITY_MATRIX.Cells);
             }
 
             //draw call
-            glDrawArrays(layer->PrimitiveType, layerBlock.Offset / VERT_SIZE, layerBlock.Used / VERT_SIZE);
+            if (layer->IsGlyphLayer)
+            {
+                //instance attributes, interleaved: position - 2 floats, scale - 2 floats, texture index - 1 uint, modulate color - 1 uint
+                glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, GLYPH_INSTANCE_SIZE, reinterpret_cast<void*>(layerBlock.Offset));
+                glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, GLYPH_INSTANCE_SIZE, reinterpret_cast<void*>(layerBlock.Offset + 2 * sizeof(float)));
+                glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, GLYPH_INSTANCE_SIZE, reinterpret_cast<void*>(layerBlock.Offset + 4 * sizeof(float)));
+                glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, GLYPH_INSTANCE_SIZE, reinterpret_cast<void*>(layerBlock.Offset + 4 * sizeof(float) + sizeof(unsigned int)));
+                glDrawArraysInstanced(GL_TRIANGLES, 0, 6, layerBlock.Used / GLYPH_INSTANCE_SIZE);
+            }
+            else
+            {
+                glDrawArrays(layer->PrimitiveType, layerBlock.Offset / VERT_SIZE, layerBlock.Used / VERT_SIZE);
+            }
+        }
+
+        if (usedShader != TiledShader)
+        {
+            glUseProgram(TiledShader->Program);
+            glBindVertexArray(Vao);
         }
 
         glfwSwapBuffers(Window);
         glfwPollEvents();
+        FrameIndex++;
     }
 }
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//calls 'function' for every index in [0, count) using all hardware threads, blocks until every call has returned
+//indices are handed out one by one, so calls of uneven cost are balanced between threads
+//if any call throws, the first exception is rethrown on the calling thread after the others have finished
+inline void ParallelFor(size_t count, std::function<void(size_t)> function)
+{
+    size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+    std::atomic<size_t> nextIndex = 0;
+    std::exception_ptr exception = NULL;
+    std::atomic_flag exceptionSet = ATOMIC_FLAG_INIT;
+
+    auto worker = [&]()
+    {
+        for (size_t i = nextIndex++; i < count; i = nextIndex++)
+        {
+            try
+            {
+                function(i);
+            }
+            catch (...)
+            {
+                if (!exceptionSet.test_and_set())
+                    exception = std::current_exception();
+                nextIndex = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker(); //calling thread does it's share of work too
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (exception != NULL)
+        std::rethrow_exception(exception);
+}
+
+//persistent worker threads running queued tasks in the background, tasks are started in the order they were queued
+//threads are started on the first 'Submit', tasks which haven't started yet are dropped upon destruction
+struct TaskQueue
+{
+    std::vector<std::thread> Threads;
+    std::deque<std::function<void()>> Tasks;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    bool IsStopping = false;
+
+    void Submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(Mutex);
+            Tasks.push_back(task);
+        }
+        Condition.notify_one();
+
+        if (!Threads.empty())
+            return;
+
+        size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            Threads.emplace_back([this]() { Work(); });
+        }
+    }
+
+    void Work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(Mutex);
+                Condition.wait(lock, [this]() { return IsStopping || !Tasks.empty(); });
+                if (IsStopping)
+                    return;
+
+                task = std::move(Tasks.front());
+                Tasks.pop_front();
+            }
+
+            task(); //tasks are expected to handle their own exceptions
+        }
+    }
+
+    ~TaskQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(Mutex);
+            IsStopping = true;
+            Tasks.clear();
+        }
+        Condition.notify_all();
+
+        for (std::thread& thread : Threads)
+        {
+            thread.join();
+        }
+    }
+};
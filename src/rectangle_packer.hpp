@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
+#include <tuple>
 #include <vector>
 #include <vec2.hpp>
 
@@ -10,67 +13,247 @@ struct Rect
 
 	unsigned int Width = 0;
 	unsigned int Height = 0;
+	bool IsRotated = false; //set only by the packer, rect is stored rotated by 90 degrees (width & height are swapped)
+
+	unsigned int Page = 0; //set only by the atlas
 
 	std::tuple<long, long, long, long> Data; //not used for packing
 };
 
+enum class PackingStrategy
+{
+	Skyline, //places rects on top of the outline of packed area, fast but space under overhangs is lost
+	MaxRects, //tracks all maximal free rects, slower but packs tighter
+};
+
 struct RectanglePacker
 {
 	std::vector<Rect> Rects;
 	std::vector<Rect> PackedRects;
-	std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> HeightLevels = {};
+	PackingStrategy Strategy = PackingStrategy::Skyline; //mustn't be changed once rects are packed
+	bool AllowRotation = false; //rects may be rotated by 90 degrees if they fit better that way
 	unsigned int TotalWidth = 0;
 	unsigned int TotalHeight = 0;
+	unsigned int MaxWidth = std::numeric_limits<unsigned int>().max(); //packed area never exceeds these
+	unsigned int MaxHeight = std::numeric_limits<unsigned int>().max();
+
+	std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> Skyline = {}; //x, y & width of segments forming the top edge of packed area
+	std::vector<Rect> FreeRects = {}; //maximal free rects, possibly overlapping
+	bool IsStarted = false;
 
-	//not very efficient but it's good enough
-	void Pack()
+	//candidate position of a rect, positions keeping the packed area close to a square are preferred, then ones growing it the least
+	//'Fit' breaks the remaining ties: height of the position for skyline, shorter leftover side of the free rect for max rects
+	struct Placement
 	{
-		std::sort(Rects.begin(), Rects.end(), [](Rect rect1, Rect rect2) { return rect1.Width > rect2.Width; });
+		bool IsFound = false;
+		unsigned int X = 0;
+		unsigned int Y = 0;
+		bool IsRotated = false;
+		unsigned long long Side = 0;
+		unsigned long long Delta = 0;
+		unsigned long long Fit = 0;
+	};
 
-		for (Rect& rect : Rects)
+	void Consider(Placement& best, unsigned int x, unsigned int y, unsigned int width, unsigned int height, bool isRotated, unsigned long long fit)
+	{
+		unsigned long long newWidth = std::max(TotalWidth, x + width);
+		unsigned long long newHeight = std::max(TotalHeight, y + height);
+		unsigned long long side = std::max(newWidth, newHeight);
+		unsigned long long delta = newWidth * newHeight - static_cast<unsigned long long>(TotalWidth) * TotalHeight;
+
+		if (!best.IsFound || std::tie(side, delta, fit) < std::tie(best.Side, best.Delta, best.Fit))
+			best = { true, x, y, isRotated, side, delta, fit };
+	}
+
+	void FindSkylinePlacement(Placement& best, unsigned int width, unsigned int height, bool isRotated)
+	{
+		for (size_t i = 0; i < Skyline.size(); i++)
 		{
-			int selectedIndex;
-			int deltaX, deltaY;
-			int minDelta = std::numeric_limits<int>().max();
-			HeightLevels.push_back({ TotalWidth, 0, rect.Width }); //there's always an option to place rect at the rightmost point
+			auto [x, y, _] = Skyline[i];
+			if (width > MaxWidth - x)
+				break;
 
-			for (int i = 0; i < HeightLevels.size(); i++)
+			//the rect lies on the highest segment it spans
+			unsigned int spanned = 0;
+			for (size_t j = i; spanned < width; j++)
 			{
-				auto [x, y, width] = HeightLevels[i];
-
-				if (width < rect.Width)
-					continue;
-
-				int dx = x + rect.Width - TotalWidth; dx = std::max(dx, 0);
-				int dy = y + rect.Height - TotalHeight; dy = std::max(dy, 0);
-				int ds = dx * TotalHeight + dy * TotalWidth + dx * dy;
-
-				if (ds < minDelta)
-				{
-					selectedIndex = i;
-					deltaX = dx;
-					deltaY = dy;
-					minDelta = ds;
-				}
+				y = std::max(y, std::get<1>(Skyline[j]));
+				spanned += std::get<2>(Skyline[j]);
 			}
 
-			TotalWidth += deltaX;
-			TotalHeight += deltaY;
+			if (height <= MaxHeight - y)
+				Consider(best, x, y, width, height, isRotated, y);
+		}
+	}
 
-			auto& [selectedX, selectedY, selectedWidth] = HeightLevels[selectedIndex];
-			rect.X = selectedX;
-			rect.Y = selectedY;
+	void FindMaxRectsPlacement(Placement& best, unsigned int width, unsigned int height, bool isRotated)
+	{
+		for (Rect freeRect : FreeRects)
+		{
+			if (width <= freeRect.Width && height <= freeRect.Height)
+				Consider(best, freeRect.X, freeRect.Y, width, height, isRotated, std::min(freeRect.Width - width, freeRect.Height - height));
+		}
+	}
 
-			if (selectedIndex != HeightLevels.size() - 1)
-				HeightLevels.pop_back();
+	//replaces covered segments with the top edge of the rect, the last one can be covered partially
+	void PlaceOnSkyline(Rect rect)
+	{
+		size_t start = 0;
+		while (std::get<0>(Skyline[start]) != rect.X)
+		{
+			start++;
+		}
 
-			selectedX += rect.Width;
-			selectedWidth -= rect.Width;
-			if (selectedWidth == 0)
-				HeightLevels.erase(HeightLevels.begin() + selectedIndex);
-			HeightLevels.push_back({ selectedX, selectedY, rect.Width });
+		size_t end = start;
+		unsigned int right = rect.X + rect.Width;
+		while (end < Skyline.size() && std::get<0>(Skyline[end]) + std::get<2>(Skyline[end]) <= right)
+		{
+			end++;
+		}
 
-			PackedRects.push_back(rect);
+		if (end < Skyline.size() && std::get<0>(Skyline[end]) < right)
+		{
+			auto& [x, y, width] = Skyline[end];
+			width -= right - x;
+			x = right;
+		}
+
+		Skyline.erase(Skyline.begin() + start, Skyline.begin() + end);
+		Skyline.insert(Skyline.begin() + start, { rect.X, rect.Y + rect.Height, rect.Width });
+
+		//merging neighbours of the same height
+		for (size_t i = std::max(start, static_cast<size_t>(1)) - 1; i + 1 < Skyline.size() && i <= start;)
+		{
+			if (std::get<1>(Skyline[i]) == std::get<1>(Skyline[i + 1]))
+			{
+				std::get<2>(Skyline[i]) += std::get<2>(Skyline[i + 1]);
+				Skyline.erase(Skyline.begin() + i + 1);
+			}
+			else
+			{
+				i++;
+			}
 		}
 	}
+
+	//splits every free rect overlapping the placed one into up to four maximal rects around it, then removes rects contained in others
+	void PlaceIntoFreeRects(Rect rect)
+	{
+		std::vector<Rect> splitRects;
+		for (size_t i = 0; i < FreeRects.size();)
+		{
+			Rect freeRect = FreeRects[i];
+			if (rect.X >= freeRect.X + freeRect.Width || freeRect.X >= rect.X + rect.Width || rect.Y >= freeRect.Y + freeRect.Height || freeRect.Y >= rect.Y + rect.Height)
+			{
+				i++;
+				continue;
+			}
+
+			if (rect.X > freeRect.X)
+				splitRects.push_back({ .X = freeRect.X, .Y = freeRect.Y, .Width = rect.X - freeRect.X, .Height = freeRect.Height });
+			if (rect.X + rect.Width < freeRect.X + freeRect.Width)
+				splitRects.push_back({ .X = rect.X + rect.Width, .Y = freeRect.Y, .Width = freeRect.X + freeRect.Width - rect.X - rect.Width, .Height = freeRect.Height });
+			if (rect.Y > freeRect.Y)
+				splitRects.push_back({ .X = freeRect.X, .Y = freeRect.Y, .Width = freeRect.Width, .Height = rect.Y - freeRect.Y });
+			if (rect.Y + rect.Height < freeRect.Y + freeRect.Height)
+				splitRects.push_back({ .X = freeRect.X, .Y = rect.Y + rect.Height, .Width = freeRect.Width, .Height = freeRect.Y + freeRect.Height - rect.Y - rect.Height });
+
+			FreeRects[i] = FreeRects.back();
+			FreeRects.pop_back();
+		}
+
+		auto contains = [](Rect outer, Rect inner)
+		{
+			return inner.X >= outer.X && inner.Y >= outer.Y && inner.X + inner.Width <= outer.X + outer.Width && inner.Y + inner.Height <= outer.Y + outer.Height;
+		};
+
+		//only the new rects can be contained in others or contain them
+		for (size_t i = 0; i < splitRects.size(); i++)
+		{
+			bool isContained = false;
+			for (size_t j = 0; j < splitRects.size() && !isContained; j++)
+			{
+				isContained = i != j && contains(splitRects[j], splitRects[i]) && (!contains(splitRects[i], splitRects[j]) || j < i);
+			}
+			for (size_t j = 0; j < FreeRects.size() && !isContained; j++)
+			{
+				isContained = contains(FreeRects[j], splitRects[i]);
+			}
+
+			if (isContained)
+				continue;
+
+			std::erase_if(FreeRects, [&](Rect freeRect) { return contains(splitRects[i], freeRect); });
+			FreeRects.push_back(splitRects[i]);
+		}
+	}
+
+	//packs a single rect, leaving 'Rects' untouched, so rects can be added one at a time
+	//returns false if the rect doesn't fit into max bounds, if it's rotated it's width & height are swapped
+	bool Insert(Rect& rect)
+	{
+		if (!IsStarted)
+		{
+			Skyline.push_back({ 0, 0, MaxWidth });
+			FreeRects.push_back({ .Width = MaxWidth, .Height = MaxHeight });
+			IsStarted = true;
+		}
+
+		Placement best;
+		for (bool isRotated : { false, true })
+		{
+			if (isRotated && (!AllowRotation || rect.Width == rect.Height))
+				break;
+
+			unsigned int width = isRotated ? rect.Height : rect.Width;
+			unsigned int height = isRotated ? rect.Width : rect.Height;
+			if (Strategy == PackingStrategy::Skyline)
+				FindSkylinePlacement(best, width, height, isRotated);
+			else
+				FindMaxRectsPlacement(best, width, height, isRotated);
+		}
+
+		if (!best.IsFound)
+			return false;
+
+		if (best.IsRotated)
+			std::swap(rect.Width, rect.Height);
+		rect.X = best.X;
+		rect.Y = best.Y;
+		rect.IsRotated = best.IsRotated;
+		TotalWidth = std::max(TotalWidth, rect.X + rect.Width);
+		TotalHeight = std::max(TotalHeight, rect.Y + rect.Height);
+
+		if (Strategy == PackingStrategy::Skyline)
+			PlaceOnSkyline(rect);
+		else
+			PlaceIntoFreeRects(rect);
+
+		PackedRects.push_back(rect);
+		return true;
+	}
+
+	//sorts & packs 'Rects', larger rects go first
+	//rects which don't fit into max bounds are removed from 'Rects' & returned
+	std::vector<Rect> Pack()
+	{
+		std::sort(Rects.begin(), Rects.end(), [&](Rect rect1, Rect rect2)
+		{
+			if (AllowRotation)
+				return std::max(rect1.Width, rect1.Height) > std::max(rect2.Width, rect2.Height);
+			return rect1.Height > rect2.Height;
+		});
+
+		std::vector<Rect> packed, unpacked;
+		for (Rect& rect : Rects)
+		{
+			if (Insert(rect))
+				packed.push_back(rect);
+			else
+				unpacked.push_back(rect);
+		}
+
+		Rects = packed;
+		return unpacked;
+	}
 };
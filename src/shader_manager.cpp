@@ -0,0 +1,203 @@
+#include <cstring>
+#include <fstream>
+#include <format>
+#include <ogl.hpp>
+
+//shader variants & on-disk cache of linked program binaries
+
+#define SHADER_VERSION "#version 430 core\n"
+#define SHADER_CACHE_VERSION 1
+
+//format: header, binary returned by 'glGetProgramBinary'
+struct ShaderCacheHeader
+{
+    char Magic[4] = { 'O', 'G', 'L', 'S' };
+    unsigned int Version = SHADER_CACHE_VERSION;
+    unsigned long long Key = 0; //same as in the file's name, guards against renamed files
+    unsigned int BinaryFormat = 0;
+    unsigned int BinarySize = 0;
+};
+
+//64 bit FNV-1a, 'hash' continues a previous one
+unsigned long long HashString(std::string_view string, unsigned long long hash = 0xCBF29CE484222325)
+{
+    for (char c : string)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3;
+    }
+    return hash;
+}
+
+int Ogl::Shader::GetUniformLocation(const std::string& name)
+{
+    auto location = UniformLocations.find(name);
+    if (location != UniformLocations.end())
+        return location->second;
+
+    int result = glGetUniformLocation(Program, name.c_str());
+    UniformLocations[name] = result;
+    return result;
+}
+
+unsigned int CompileShader(unsigned int type, const char* const* sources)
+{
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 3, sources, NULL);
+    glCompileShader(shader);
+
+    int success;
+    char msg[256];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(shader, 256, NULL, msg);
+        throw std::runtime_error(std::format("Error while compiling the {} shader: '{}'.", type == GL_VERTEX_SHADER ? "vertex" : "fragment", msg));
+    }
+
+    return shader;
+}
+
+//compiles & links shader program from the sources, 'defines' are inserted after the version directive to select a variant
+unsigned int CompileShaders(const char* vertexSource, const char* fragmentSource, const char* defines, bool isRetrievable)
+{
+    const char* vertexSources[3] = { SHADER_VERSION, defines, vertexSource };
+    const char* fragmentSources[3] = { SHADER_VERSION, defines, fragmentSource };
+    unsigned int vertShader = CompileShader(GL_VERTEX_SHADER, vertexSources);
+    unsigned int fragShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSources);
+
+    unsigned int shaders;
+    shaders = glCreateProgram();
+    glAttachShader(shaders, vertShader);
+    glAttachShader(shaders, fragShader);
+    if (isRetrievable)
+        glProgramParameteri(shaders, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(shaders);
+
+    int success;
+    char msg[256];
+    glGetProgramiv(shaders, GL_LINK_STATUS, &success);
+    if(!success)
+    {
+        glGetProgramInfoLog(shaders, 256, NULL, msg);
+        throw std::runtime_error(std::format("Error while linking shaders: '{}'.", msg));
+    }
+    glDeleteShader(vertShader);
+    glDeleteShader(fragShader);
+
+    return shaders;
+}
+
+//returns zero if there's no valid binary, binaries become invalid once the driver or the sources change
+//drivers may still reject a binary (e.g. after an update which kept the version string), it's then recompiled
+unsigned int ReadProgramBinary(std::filesystem::path path, unsigned long long key)
+{
+    std::ifstream file = std::ifstream(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return 0;
+
+    ShaderCacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(ShaderCacheHeader));
+    if (!file.good() || std::memcmp(header.Magic, ShaderCacheHeader().Magic, 4) != 0 || header.Version != SHADER_CACHE_VERSION || header.Key != key)
+        return 0;
+
+    std::vector<char> binary(header.BinarySize);
+    file.read(binary.data(), binary.size());
+    if (!file.good())
+        return 0;
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.BinaryFormat, binary.data(), binary.size());
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        Ogl::Log(std::format("Shader cache '{}' was rejected by the driver.\n", path.string()));
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+//failing to write the cache isn't an error, the program will just be compiled again next time
+void WriteProgramBinary(std::filesystem::path path, unsigned long long key, unsigned int program)
+{
+    int size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size == 0)
+        return;
+
+    ShaderCacheHeader header;
+    header.Key = key;
+    std::vector<char> binary(size);
+    glGetProgramBinary(program, size, NULL, &header.BinaryFormat, binary.data());
+    header.BinarySize = size;
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::ofstream file = std::ofstream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(ShaderCacheHeader));
+    file.write(binary.data(), binary.size());
+
+    if (!file.good())
+    {
+        Ogl::Log(std::format("Failed to write shader cache '{}'.\n", path.string()));
+        file.close();
+        std::filesystem::remove(path, error);
+    }
+}
+
+//returns the program built from the sources with 'defines' set, building it on the first request
+//programs are cached in 'ShaderCacheDirectory' keyed by hash of their sources, defines & driver's vendor, renderer & version,
+//so they're loaded with 'glProgramBinary' instead of being compiled on next launches
+Ogl::Shader& Ogl::GetShader(const char* vertexSource, const char* fragmentSource, std::vector<std::string> defines)
+{
+    std::string definesSource;
+    for (const std::string& define : defines)
+    {
+        definesSource += std::format("#define {}\n", define);
+    }
+
+    unsigned long long key = HashString(SHADER_VERSION);
+    key = HashString(definesSource, key);
+    key = HashString(vertexSource, key);
+    key = HashString(std::string_view("\0", 1), key); //so that moving code between the sources changes the key
+    key = HashString(fragmentSource, key);
+
+    auto shader = Shaders.find(key);
+    if (shader != Shaders.end())
+        return shader->second;
+
+    int formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    bool useCache = !ShaderCacheDirectory.empty() && formatCount > 0;
+
+    std::filesystem::path cachePath;
+    unsigned long long cacheKey = key;
+    unsigned int program = 0;
+    if (useCache)
+    {
+        for (unsigned int name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        {
+            cacheKey = HashString(reinterpret_cast<const char*>(glGetString(name)), cacheKey);
+        }
+
+        cachePath = ShaderCacheDirectory / std::format("{:016x}{}", cacheKey, SHADER_CACHE_EXT);
+        program = ReadProgramBinary(cachePath, cacheKey);
+    }
+
+    if (program == 0)
+    {
+        program = CompileShaders(vertexSource, fragmentSource, definesSource.c_str(), useCache);
+        if (useCache)
+            WriteProgramBinary(cachePath, cacheKey, program);
+        Log(std::format("Compiled shader program {:016x}.\n", key));
+    }
+    else
+    {
+        Log(std::format("Loaded shader program {:016x} from cache.\n", key));
+    }
+
+    return Shaders[key] = Shader { .Program = program };
+}
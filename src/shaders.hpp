@@ -5,50 +5,269 @@
 #define STRINGIFY_(x) #x
 #define STRINGIFY(x) STRINGIFY_(x)
 
+//sources don't include the version directive, it's followed by variant's defines when compiling, see 'GetShader'
+//TEXTURES - primitives can be textured, otherwise only modulate colors are drawn
+//TILING - texture coordinates can go outside of [0, 1], textures are then repeated by the fragment shader
+
+//texture dimensions & samplers shared by all stages
+#define TEXTURE_DATA_SOURCE \
+    "uniform sampler2DArray AtlasTexture;\n" /*atlas pages are layers of the array*/ \
+    "layout (binding = " STRINGIFY(GLYPH_ATLAS_UNIT) ") uniform sampler2DArray GlyphAtlasTexture;\n" /*single channel*/ \
+    "layout (binding = " STRINGIFY(DYNAMIC_ATLAS_UNIT) ") uniform sampler2DArray DynamicAtlasTexture;\n" \
+    "layout (binding = " STRINGIFY(DYNAMIC_R8_ATLAS_UNIT) ") uniform sampler2DArray DynamicR8AtlasTexture;\n" /*scalars, one array per format*/ \
+    "layout (binding = " STRINGIFY(DYNAMIC_R16F_ATLAS_UNIT) ") uniform sampler2DArray DynamicR16FAtlasTexture;\n" \
+    "struct TextureData\n" \
+    "{\n" \
+    "    uvec4 Rect;\n" /*format: x - x, y - y, z - width, w - height*/ \
+    "    uint Flags;\n" \
+    "    uint Page;\n" \
+    "    uint Palette;\n" \
+    "    uint OffsetX;\n" /*position of the stored part of trimmed images & their whole size, scalars so the layout matches the C++ struct*/ \
+    "    uint OffsetY;\n" \
+    "    uint SourceWidth;\n" \
+    "    uint SourceHeight;\n" \
+    "};\n" \
+    "layout (binding = " STRINGIFY(SSBO_BINDING) ", std430) buffer TextureDimensionsBuffer\n" \
+    "{\n" \
+    "    TextureData TextureDimensions[];\n" \
+    "};\n"
+
+//dynamic textures are stored in the atlas of their format, it's selected by their flags, see 'DynamicTextureFormat'
+//they have no mip levels, so they're always sampled from the first one
+#define DYNAMIC_ATLAS_SOURCE \
+    "ivec3 GetDynamicAtlasSize(uint flags)\n" \
+    "{\n" \
+    "   if ((flags & " STRINGIFY(TEXTURE_FLAG_HALF_FLOAT) "u) != 0)\n" \
+    "       return textureSize(DynamicR16FAtlasTexture, 0);\n" \
+    "   if ((flags & " STRINGIFY(TEXTURE_FLAG_SCALAR) "u) != 0)\n" \
+    "       return textureSize(DynamicR8AtlasTexture, 0);\n" \
+    "   return textureSize(DynamicAtlasTexture, 0);\n" \
+    "}\n" \
+    "vec4 SampleDynamicAtlas(uint flags, vec3 coords)\n" \
+    "{\n" \
+    "   if ((flags & " STRINGIFY(TEXTURE_FLAG_HALF_FLOAT) "u) != 0)\n" \
+    "       return textureLod(DynamicR16FAtlasTexture, coords, 0.0f);\n" \
+    "   if ((flags & " STRINGIFY(TEXTURE_FLAG_SCALAR) "u) != 0)\n" \
+    "       return textureLod(DynamicR8AtlasTexture, coords, 0.0f);\n" \
+    "   return textureLod(DynamicAtlasTexture, coords, 0.0f);\n" \
+    "}\n"
+
+//converts texture coordinates from [0, 1] to normalized coordinates of the atlas, linear so it can be done per vertex
+//coordinates of trimmed images are relative to the whole image, so they're mapped to it's stored part first
+#define ATLAS_COORDS_SOURCE \
+    "vec2 GetTrimmedCoords(TextureData textureData, vec2 coords)\n" \
+    "{\n" \
+    "   vec2 sourceSize = vec2(textureData.SourceWidth, textureData.SourceHeight);\n" \
+    "   return (coords * sourceSize - vec2(textureData.OffsetX, textureData.OffsetY)) / vec2(textureData.Rect.zw);\n" \
+    "}\n" \
+    "vec2 GetAtlasCoords(TextureData textureData, vec2 coords)\n" \
+    "{\n" \
+    "   if ((textureData.Flags & " STRINGIFY(TEXTURE_FLAG_TRIMMED) "u) != 0)\n" \
+    "       coords = GetTrimmedCoords(textureData, coords);\n" \
+    "   vec2 size = vec2(textureData.Rect.zw);\n" \
+    "   if ((textureData.Flags & " STRINGIFY(TEXTURE_FLAG_ROTATED) "u) != 0)\n" /*stored with x & y swapped*/ \
+    "   {\n" \
+    "       coords = coords.yx;\n" \
+    "       size = size.yx;\n" \
+    "   }\n" \
+    "   bool isGlyph = (textureData.Flags & " STRINGIFY(TEXTURE_FLAG_GLYPH) "u) != 0;\n" \
+    "   bool isDynamic = (textureData.Flags & " STRINGIFY(TEXTURE_FLAG_DYNAMIC) "u) != 0;\n" \
+    "   vec2 atlasSize = vec2(isGlyph ? textureSize(GlyphAtlasTexture, 0).xy : isDynamic ? GetDynamicAtlasSize(textureData.Flags).xy : textureSize(AtlasTexture, 0).xy);\n" \
+    "   return (vec2(textureData.Rect.xy) + coords * size) / atlasSize;\n" \
+    "}\n"
+
+//maps a scalar value of a dynamic texture to color of it's palette, zero & one are mapped to centers of the first & the last pixels of the palette's bottom row
+//values are shown as grayscale if there's no palette
+#define PALETTE_SOURCE \
+    "vec4 GetPaletteColor(float value, uint palette)\n" \
+    "{\n" \
+    "   value = clamp(value, 0.0f, 1.0f);\n" \
+    "   if (palette == 0)\n" \
+    "       return vec4(vec3(value), 1.0f);\n" \
+    "   TextureData paletteData = TextureDimensions[palette];\n" \
+    "   float width = float(paletteData.Rect.z);\n" \
+    "   vec2 coords = GetAtlasCoords(paletteData, vec2((0.5f + value * (width - 1.0f)) / width, 0.5f / float(paletteData.Rect.w)));\n" \
+    "   if ((paletteData.Flags & " STRINGIFY(TEXTURE_FLAG_DYNAMIC) "u) != 0)\n" \
+    "       return SampleDynamicAtlas(paletteData.Flags, vec3(coords, paletteData.Page));\n" \
+    "   return textureLod(AtlasTexture, vec3(coords, paletteData.Page), 0.0f);\n" \
+    "}\n"
+
+//samples a dynamic texture, scalar ones are color mapped
+#define DYNAMIC_SAMPLE_SOURCE(coords, page) \
+    "       color = SampleDynamicAtlas(flags, vec3(" coords ", " page "));\n" \
+    "       if ((flags & " STRINGIFY(TEXTURE_FLAG_SCALAR) "u) != 0)\n" \
+    "           color = GetPaletteColor(color.r, TextureDimensions[TextureIndex].Palette);\n"
+
 const static char* VertexShaderSource =
-    "#version 430 core\n"
     "layout (location = 0) in vec2 Coords;\n"
     "layout (location = 1) in vec2 TextureCoordsIn;\n"
     "layout (location = 2) in uint TextureIndexIn;\n"
     "layout (location = 3) in uint ModulateColorIn;\n"
     "uniform mat3 NDCMatrix;\n"
+    TEXTURE_DATA_SOURCE
+    DYNAMIC_ATLAS_SOURCE
+    ATLAS_COORDS_SOURCE
     "out vec2 TextureCoords;\n"
+    "out vec2 AtlasCoords;\n"
     "flat out uint TextureIndex;\n"
+    "flat out uint TextureFlags;\n"
+    "flat out uint TexturePage;\n"
     "out vec4 ModulateColor;\n"
     "void main()\n"
     "{\n"
     "   TextureCoords = TextureCoordsIn;\n"
     "   TextureIndex = TextureIndexIn;\n"
-    "   float modulateR = (ModulateColorIn & 0xFF) / 255.0f;\n"
-    "   float modulateG = (ModulateColorIn >> 8 & 0xFF) / 255.0f;\n"
-    "   float modulateB = (ModulateColorIn >> 16 & 0xFF) / 255.0f;\n"
-    "   float modulateA = (ModulateColorIn >> 24 & 0xFF) / 255.0f;\n"
+    "   float modulateR = (ModulateColorIn & 0xFFu) / 255.0f;\n"
+    "   float modulateG = (ModulateColorIn >> 8 & 0xFFu) / 255.0f;\n"
+    "   float modulateB = (ModulateColorIn >> 16 & 0xFFu) / 255.0f;\n"
+    "   float modulateA = (ModulateColorIn >> 24 & 0xFFu) / 255.0f;\n"
     "   ModulateColor = vec4(modulateR, modulateG, modulateB, modulateA);\n"
+    "#if defined(TEXTURES) && !defined(TILING)\n" //repeated textures can't be interpolated in atlas space, they're resolved per fragment
+    "   TextureData textureData = TextureDimensions[TextureIndexIn];\n"
+    "   AtlasCoords = GetAtlasCoords(textureData, TextureCoordsIn);\n"
+    "   TextureFlags = textureData.Flags;\n"
+    "   TexturePage = textureData.Page;\n"
+    "#endif\n"
     "   vec3 ndc = NDCMatrix * vec3(Coords, 1.0f);\n"
     "   gl_Position = vec4(ndc.xy, 0.0f, 1.0f);\n"
     "}\n";
 
 const static char* FragmentShaderSource =
-    "#version 430 core\n"
     "in vec2 TextureCoords;\n"
+    "in vec2 AtlasCoords;\n"
     "flat in uint TextureIndex;\n"
+    "flat in uint TextureFlags;\n"
+    "flat in uint TexturePage;\n"
     "in vec4 ModulateColor;\n"
     "uniform float DrawingDepth;\n"
-    "uniform sampler2D AtlasTexture;\n"
-    "layout (binding = " STRINGIFY(SSBO_BINDING) ", std430) buffer TextureDimensionsBuffer\n" //format: x - x, y - y, z - width, w - height
-    "{\n"
-    "    uvec4 TextureDimensions[];\n"
-    "};\n"
+    TEXTURE_DATA_SOURCE
+    DYNAMIC_ATLAS_SOURCE
+    ATLAS_COORDS_SOURCE
+    PALETTE_SOURCE
     "out vec4 FragColor;\n"
     "void main()\n"
     "{\n"
-    "   vec2 atlasSize = vec2(textureSize(AtlasTexture, 0));\n"
-    "   vec4 texData = vec4(TextureDimensions[TextureIndex]);\n"
-    "   texData.x /= atlasSize.x; texData.y /= atlasSize.y; texData.z /= atlasSize.x; texData.w /= atlasSize.y;\n"
-    "   vec2 atlasCoords = texData.xy + vec2(mod(TextureCoords.x, 1.0f) * texData.z, mod(TextureCoords.y, 1.0f) * texData.w);\n"
-    "   vec4 color = texture(AtlasTexture, atlasCoords)\n;"
+    "#ifndef TEXTURES\n" //same as blending with an invalid texture below
+    "   FragColor = vec4(ModulateColor.rgb, 1.0f);\n"
+    "#else\n"
+    "#ifdef TILING\n"
+    "   TextureData textureData = TextureDimensions[TextureIndex];\n"
+    "   uint flags = textureData.Flags;\n"
+    "   vec2 localCoords = vec2(mod(TextureCoords.x, 1.0f), mod(TextureCoords.y, 1.0f));\n"
+    "#else\n"
+    "   uint flags = TextureFlags;\n"
+    "   vec2 localCoords = TextureCoords;\n"
+    "#endif\n"
+    "   vec4 color;\n"
+    "   if ((flags & " STRINGIFY(TEXTURE_FLAG_SDF) "u) != 0)\n" //signed distance fields are always glyphs
+    "   {\n"
+    //atlas uses nearest filtering, so distance is interpolated manually without sampling outside of the texture's rect
+    "       TextureData sdfData = TextureDimensions[TextureIndex];\n"
+    "       vec2 size = vec2(sdfData.Rect.zw);\n"
+    "       vec2 texel = localCoords * size - 0.5f;\n"
+    "       vec2 weight = fract(texel);\n"
+    "       int page = int(sdfData.Page);\n"
+    "       ivec2 low = ivec2(clamp(floor(texel), vec2(0.0f), size - 1.0f)) + ivec2(sdfData.Rect.xy);\n"
+    "       ivec2 high = ivec2(clamp(floor(texel) + 1.0f, vec2(0.0f), size - 1.0f)) + ivec2(sdfData.Rect.xy);\n"
+    "       float bottom = mix(texelFetch(GlyphAtlasTexture, ivec3(low, page), 0).r, texelFetch(GlyphAtlasTexture, ivec3(high.x, low.y, page), 0).r, weight.x);\n"
+    "       float top = mix(texelFetch(GlyphAtlasTexture, ivec3(low.x, high.y, page), 0).r, texelFetch(GlyphAtlasTexture, ivec3(high, page), 0).r, weight.x);\n"
+    "       float distance = mix(bottom, top, weight.y);\n"
+    "       float smoothing = max(fwidth(distance) * 0.5f, 0.001f);\n"
+    "       color = vec4(1.0f, 1.0f, 1.0f, smoothstep(0.5f - smoothing, 0.5f + smoothing, distance));\n"
+    "   }\n"
+    "#ifndef TILING\n" //atlas coordinates were interpolated from the vertices, so mip level is selected by their derivatives
+    "   else if ((flags & " STRINGIFY(TEXTURE_FLAG_GLYPH) "u) != 0)\n"
+    "   {\n"
+    "       color = vec4(1.0f, 1.0f, 1.0f, texture(GlyphAtlasTexture, vec3(AtlasCoords, TexturePage)).r);\n"
+    "   }\n"
+    "   else if ((flags & " STRINGIFY(TEXTURE_FLAG_DYNAMIC) "u) != 0)\n"
+    "   {\n"
+    DYNAMIC_SAMPLE_SOURCE("AtlasCoords", "TexturePage")
+    "   }\n"
+    "   else\n"
+    "   {\n"
+    "       color = texture(AtlasTexture, vec3(AtlasCoords, TexturePage));\n"
+    "       if ((flags & " STRINGIFY(TEXTURE_FLAG_TRIMMED) "u) != 0)\n" //trimmed borders are transparent
+    "       {\n"
+    "           vec2 trimmedCoords = GetTrimmedCoords(TextureDimensions[TextureIndex], localCoords);\n"
+    "           color *= float(all(greaterThanEqual(trimmedCoords, vec2(0.0f))) && all(lessThanEqual(trimmedCoords, vec2(1.0f))));\n"
+    "       }\n"
+    "   }\n"
+    "#else\n"
+    "   else if ((flags & " STRINGIFY(TEXTURE_FLAG_GLYPH) "u) != 0)\n"
+    "   {\n"
+    "       vec4 texData = vec4(textureData.Rect);\n"
+    "       vec2 atlasSize = vec2(textureSize(GlyphAtlasTexture, 0).xy);\n"
+    "       vec2 atlasCoords = (texData.xy + localCoords * texData.zw) / atlasSize;\n"
+    "       color = vec4(1.0f, 1.0f, 1.0f, texture(GlyphAtlasTexture, vec3(atlasCoords, textureData.Page)).r);\n"
+    "   }\n"
+    "   else if ((flags & " STRINGIFY(TEXTURE_FLAG_DYNAMIC) "u) != 0)\n" //never rotated & has no mip levels
+    "   {\n"
+    "       vec2 atlasCoords = GetAtlasCoords(textureData, localCoords);\n"
+    DYNAMIC_SAMPLE_SOURCE("atlasCoords", "textureData.Page")
+    "   }\n"
+    "   else\n"
+    "   {\n"
+    "       vec4 texData = vec4(textureData.Rect);\n"
+    "       vec2 unwrappedCoords = TextureCoords;\n"
+    "       float isStored = 1.0f;\n"
+    "       if ((flags & " STRINGIFY(TEXTURE_FLAG_TRIMMED) "u) != 0)\n" //trimmed borders are transparent
+    "       {\n"
+    "           localCoords = GetTrimmedCoords(textureData, localCoords);\n"
+    "           unwrappedCoords *= vec2(textureData.SourceWidth, textureData.SourceHeight) / texData.zw;\n"
+    "           isStored = float(all(greaterThanEqual(localCoords, vec2(0.0f))) && all(lessThanEqual(localCoords, vec2(1.0f))));\n"
+    "       }\n"
+    "       if ((flags & " STRINGIFY(TEXTURE_FLAG_ROTATED) "u) != 0)\n" //stored with x & y swapped
+    "       {\n"
+    "           localCoords = localCoords.yx;\n"
+    "           unwrappedCoords = unwrappedCoords.yx;\n"
+    "           texData.zw = texData.wz;\n"
+    "       }\n"
+    "       vec2 atlasSize = vec2(textureSize(AtlasTexture, 0).xy);\n"
+    "       texData.x /= atlasSize.x; texData.y /= atlasSize.y; texData.z /= atlasSize.x; texData.w /= atlasSize.y;\n"
+    "       vec2 atlasCoords = texData.xy + localCoords * texData.zw;\n"
+    //derivatives of wrapped coordinates jump at the edges of repeated textures, so mip level is selected by unwrapped ones
+    "       vec2 scaledCoords = unwrappedCoords * texData.zw;\n"
+    "       color = textureGrad(AtlasTexture, vec3(atlasCoords, textureData.Page), dFdx(scaledCoords), dFdy(scaledCoords)) * isStored;\n"
+    "   }\n"
+    "#endif\n"
     "   float isValidTexture = min(1, TextureIndex)\n;"
     "   color.rbg *= isValidTexture;\n" //color.rgb = isValidTexture ? color.rgb : 0.0f
     "   color.a = max(color.a, 1.0f - isValidTexture);\n" //color.a = isValidTexture ? color.a : 1.0f
     "   FragColor = ModulateColor * color.w + color * (1.0f - ModulateColor.w);\n"
+    "#endif\n"
+    "}\n";
+
+//expands each glyph instance into a quad, 'gl_VertexID' selects the corner
+//glyph's size is taken from it's texture dimensions multiplied by the instance's scale
+//glyphs are never repeated, so it's compiled with 'TEXTURES' only
+const static char* GlyphVertexShaderSource =
+    "layout (location = 0) in vec2 Position;\n"
+    "layout (location = 1) in vec2 Scale;\n"
+    "layout (location = 2) in uint TextureIndexIn;\n"
+    "layout (location = 3) in uint ModulateColorIn;\n"
+    "uniform mat3 NDCMatrix;\n"
+    TEXTURE_DATA_SOURCE
+    DYNAMIC_ATLAS_SOURCE
+    ATLAS_COORDS_SOURCE
+    "out vec2 TextureCoords;\n"
+    "out vec2 AtlasCoords;\n"
+    "flat out uint TextureIndex;\n"
+    "flat out uint TextureFlags;\n"
+    "flat out uint TexturePage;\n"
+    "out vec4 ModulateColor;\n"
+    "const vec2 Corners[6] = vec2[](vec2(0.0f, 0.0f), vec2(0.0f, 1.0f), vec2(1.0f, 1.0f), vec2(1.0f, 1.0f), vec2(1.0f, 0.0f), vec2(0.0f, 0.0f));\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 corner = Corners[gl_VertexID];\n"
+    "   TextureData textureData = TextureDimensions[TextureIndexIn];\n"
+    "   vec2 size = vec2(textureData.Rect.zw) * Scale;\n"
+    "   TextureCoords = corner;\n"
+    "   AtlasCoords = GetAtlasCoords(textureData, corner);\n"
+    "   TextureIndex = TextureIndexIn;\n"
+    "   TextureFlags = textureData.Flags;\n"
+    "   TexturePage = textureData.Page;\n"
+    "   ModulateColor = unpackUnorm4x8(ModulateColorIn);\n"
+    "   vec3 ndc = NDCMatrix * vec3(Position + corner * size, 1.0f);\n"
+    "   gl_Position = vec4(ndc.xy, 0.0f, 1.0f);\n"
     "}\n";
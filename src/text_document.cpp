@@ -0,0 +1,226 @@
+#include <codecvt>
+#include <ogl.hpp>
+
+//text document methods
+
+static std::wstring_convert<std::codecvt_utf8<unsigned int>, unsigned int> Utf8Converter;
+
+//returns index of the chunk containing the line & line's index inside of that chunk
+std::tuple<size_t, size_t> Ogl::TextDocument::FindLine(size_t index)
+{
+    if (index >= LineCount)
+        throw std::runtime_error(std::format("Line index {} is out of document bounds.", index));
+
+    for (size_t i = 0; i < Chunks.size(); i++)
+    {
+        if (index < Chunks[i].size())
+            return { i, index };
+        index -= Chunks[i].size();
+    }
+
+    throw std::runtime_error("Document's line count doesn't match it's chunks.");
+}
+
+Ogl::TextLine& Ogl::TextDocument::GetLine(size_t index)
+{
+    auto [chunk, line] = FindLine(index);
+    return Chunks[chunk][line];
+}
+
+//returns cached layout of the line, rebuilding it if the line has been changed since the last call
+const std::vector<Ogl::GlyphLayout>& Ogl::TextDocument::GetLineLayout(size_t index)
+{
+    TextLine& line = GetLine(index);
+    if (line.IsLayoutValid)
+        return line.Layout;
+
+    if (Font == NULL)
+        throw std::runtime_error("Document has no font set.");
+
+    line.Layout.resize(line.Text.size());
+    float pixelX = 0, relativeX = 0;
+
+    for (size_t i = 0; i < line.Text.size(); i++)
+    {
+        size_t textureIndex = Font->GetGlyphIndex(line.Text[i]);
+        if (textureIndex == -1)
+            throw std::runtime_error("Character unsupported by font.");
+
+        //signed distance field glyphs are padded & upscaled in atlas
+        TextureDimensions dimensions = TextureDimensionsVector[textureIndex];
+        unsigned int width = (dimensions.Width - Font->Padding * 2) / Font->Scale;
+        unsigned int height = (dimensions.Height - Font->Padding * 2) / Font->Scale;
+
+        line.Layout[i] = { textureIndex, pixelX, relativeX, width, height };
+        pixelX += width;
+        relativeX += static_cast<float>(width) / height;
+    }
+
+    line.IsLayoutValid = true;
+    return line.Layout;
+}
+
+//returns the whole document as an utf8 string
+std::string Ogl::TextDocument::GetText()
+{
+    std::basic_string<unsigned int> text;
+    for (std::vector<TextLine>& chunk : Chunks)
+    {
+        for (TextLine& line : chunk)
+        {
+            text.append(line.Text);
+            text.push_back('\n');
+        }
+    }
+    text.pop_back();
+
+    return Utf8Converter.to_bytes(text);
+}
+
+//replaces the whole document, expects an utf8 string
+void Ogl::TextDocument::SetText(std::string text)
+{
+    Chunks = { { TextLine {} } };
+    LineCount = 1;
+    Insert(0, 0, text);
+}
+
+//inserts lines before the line with index 'index' (or at the end if it's equal to 'LineCount'), moving them out of 'lines'
+void Ogl::TextDocument::InsertLines(size_t index, std::vector<TextLine>& lines)
+{
+    size_t chunkIndex = Chunks.size() - 1;
+    size_t lineIndex = Chunks.back().size();
+    if (index < LineCount)
+        std::tie(chunkIndex, lineIndex) = FindLine(index);
+
+    std::vector<TextLine>& chunk = Chunks[chunkIndex];
+    chunk.insert(chunk.begin() + lineIndex, std::make_move_iterator(lines.begin()), std::make_move_iterator(lines.end()));
+    LineCount += lines.size();
+
+    if (chunk.size() <= TEXT_CHUNK_SIZE * 2)
+        return;
+
+    //splitting an overgrown chunk
+    std::vector<std::vector<TextLine>> newChunks;
+    for (size_t i = 0; i < chunk.size(); i += TEXT_CHUNK_SIZE)
+    {
+        size_t end = std::min(i + TEXT_CHUNK_SIZE, chunk.size());
+        newChunks.emplace_back(std::make_move_iterator(chunk.begin() + i), std::make_move_iterator(chunk.begin() + end));
+    }
+
+    Chunks.erase(Chunks.begin() + chunkIndex);
+    Chunks.insert(Chunks.begin() + chunkIndex, std::make_move_iterator(newChunks.begin()), std::make_move_iterator(newChunks.end()));
+}
+
+//removes 'count' lines starting from the line with index 'index'
+void Ogl::TextDocument::EraseLines(size_t index, size_t count)
+{
+    auto [chunkIndex, lineIndex] = FindLine(index);
+    LineCount -= count;
+
+    while (count > 0)
+    {
+        std::vector<TextLine>& chunk = Chunks[chunkIndex];
+        size_t erased = std::min(count, chunk.size() - lineIndex);
+        chunk.erase(chunk.begin() + lineIndex, chunk.begin() + lineIndex + erased);
+        count -= erased;
+        lineIndex = 0;
+
+        if (chunk.empty() && Chunks.size() > 1)
+            Chunks.erase(Chunks.begin() + chunkIndex);
+        else
+            chunkIndex++;
+    }
+}
+
+//inserts utf8 text at the specified position, only the lines touched by the insertion will have their layout rebuilt
+void Ogl::TextDocument::Insert(size_t line, size_t column, std::string text)
+{
+    std::basic_string<unsigned int> textUtf32 = Utf8Converter.from_bytes(text);
+    TextLine& first = GetLine(line);
+
+    if (column > first.Text.size())
+        throw std::runtime_error(std::format("Column {} is out of line bounds.", column));
+
+    size_t newline = textUtf32.find('\n');
+    if (newline == std::string::npos)
+    {
+        first.Text.insert(column, textUtf32);
+        first.IsLayoutValid = false;
+        return;
+    }
+
+    //splitting inserted text into lines, the tail of the first line is moved to the end of the last one
+    std::basic_string<unsigned int> tail = first.Text.substr(column);
+    first.Text.resize(column);
+    first.Text.append(textUtf32, 0, newline);
+    first.IsLayoutValid = false;
+
+    std::vector<TextLine> lines;
+    while (newline != std::string::npos)
+    {
+        size_t start = newline + 1;
+        newline = textUtf32.find('\n', start);
+        lines.push_back({ .Text = textUtf32.substr(start, newline == std::string::npos ? std::string::npos : newline - start) });
+    }
+    lines.back().Text.append(tail);
+
+    InsertLines(line + 1, lines);
+}
+
+//inserts utf8 text at the end of the document
+void Ogl::TextDocument::Append(std::string text)
+{
+    Insert(LineCount - 1, GetLine(LineCount - 1).Text.size(), text);
+}
+
+//erases 'count' characters starting from the specified position, line ends count as a single character
+void Ogl::TextDocument::Erase(size_t line, size_t column, size_t count)
+{
+    TextLine& first = GetLine(line);
+
+    if (column > first.Text.size())
+        throw std::runtime_error(std::format("Column {} is out of line bounds.", column));
+
+    //finding the position of the last erased character
+    size_t lastLine = line;
+    size_t lastColumn = column;
+    while (lastLine < LineCount)
+    {
+        size_t remaining = GetLine(lastLine).Text.size() - lastColumn;
+        if (count <= remaining || lastLine == LineCount - 1)
+        {
+            lastColumn += std::min(count, remaining);
+            break;
+        }
+
+        count -= remaining + 1;
+        lastLine++;
+        lastColumn = 0;
+    }
+
+    if (lastLine == line)
+    {
+        first.Text.erase(column, lastColumn - column);
+    }
+    else
+    {
+        first.Text.resize(column);
+        first.Text.append(GetLine(lastLine).Text.substr(lastColumn));
+        EraseLines(line + 1, lastLine - line);
+    }
+
+    GetLine(line).IsLayoutValid = false;
+}
+
+//marks layout of every line as invalid, should be called after changing the font
+void Ogl::TextDocument::InvalidateLayout()
+{
+    for (std::vector<TextLine>& chunk : Chunks)
+    {
+        for (TextLine& line : chunk)
+        {
+            line.IsLayoutValid = false;
+        }
+    }
+}
@@ -2,347 +2,1959 @@
 #include <filesystem>
 #include <fstream>
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <unordered_set>
 #include <glad/glad.h>
 #include <stb_image.h>
 #include <stb_image_write.h>
 #include <ogl.hpp>
 #include <rectangle_packer.hpp>
+#include <parallel.hpp>
+#include <mapped_file.hpp>
+#include <atlas.hpp>
+#include <block_compression.hpp>
+#include <json.hpp>
 
 //texture methods
 
 //'GL_NEAREST' - no filtering, 'GL_LINEAR' - linear interpolation
 void Ogl::SetTextureFilter(unsigned int minification, unsigned int magnification)
 {
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minification);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magnification);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minification);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magnification);
 }
 
-Ogl::Texture AddTexture(std::filesystem::path path, Rect rect)
+Ogl::TextureHandle Ogl::TextureTable::GetHandle(size_t index) const
 {
-    Ogl::TextureDimensionsVector.push_back({ rect.X, rect.Y, rect.Width, rect.Height });
-    Ogl::TexturesToUpdate.push_back(Ogl::Textures.size());
-    Ogl::Textures.push_back({ path, Ogl::Textures.size() });
-    return Ogl::Textures.back();
+    return { .Index = static_cast<unsigned int>(index), .Generation = Generations[index] };
 }
 
-void UpdateTextureData()
+//false for handles of unloaded textures, even if their index has been reused
+bool Ogl::TextureTable::IsValid(TextureHandle texture) const
 {
-    size_t maxIndex = *std::max_element(Ogl::TexturesToUpdate.begin(), Ogl::TexturesToUpdate.end());
-    size_t requiredSsboSize = (maxIndex + 1) * sizeof(Ogl::TextureDimensions);
-    if (Ogl::Ssbo.Size < requiredSsboSize)
-        throw std::runtime_error("Out of video memory.");
+    return texture.Index != 0 && texture.Index < Generations.size() && Generations[texture.Index] == texture.Generation && TextureDimensionsVector[texture.Index].Width != 0;
+}
 
-    for (size_t index : Ogl::TexturesToUpdate)
+//indices of unloaded textures are reused only by images, glyphs of a font must have consecutive indices
+//only images have paths, they're used for unloading baked textures
+Ogl::TextureHandle AddTexture(Rect rect, unsigned int flags, std::filesystem::path path)
+{
+    bool isImage = (flags & TEXTURE_FLAG_GLYPH) == 0;
+    flags |= rect.IsRotated ? TEXTURE_FLAG_ROTATED : 0;
+
+    Ogl::TextureDimensions dimensions = { rect.X, rect.Y, rect.Width, rect.Height, flags, rect.Page, 0, 0, 0, rect.Width, rect.Height };
+    size_t index = Ogl::TextureDimensionsVector.size();
+    if (isImage && !Ogl::FreeTextureIndices.empty())
+    {
+        index = Ogl::FreeTextureIndices.back();
+        Ogl::FreeTextureIndices.pop_back();
+        Ogl::TextureDimensionsVector[index] = dimensions;
+    }
+    else
     {
-        Ogl::TextureDimensions dimensions = Ogl::TextureDimensionsVector[index];
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, index * sizeof(Ogl::TextureDimensions), sizeof(Ogl::TextureDimensions), &dimensions);
+        if (index >= 1 << TEXTURE_INDEX_BITS)
+            throw std::runtime_error("Too many textures.");
+
+        Ogl::TextureDimensionsVector.push_back(dimensions);
+        Ogl::Textures.Generations.push_back(0);
     }
 
-    Ogl::TexturesToUpdate.clear();
+    if (!path.empty())
+        Ogl::Textures.Paths[index] = path;
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Ogl::AtlasWidth, Ogl::AtlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, Ogl::AtlasData);
+    Ogl::TexturesToUpdate.push_back(index);
+    return Ogl::Textures.GetHandle(index);
 }
 
-void InitializeAtlas()
+//paths of baked textures are stored as written, so they don't have to exist when the atlas is loaded
+std::string GetBakedTextureKey(std::filesystem::path path)
 {
-    glGenTextures(1, &Ogl::Atlas);
-    glBindTexture(GL_TEXTURE_2D, Ogl::Atlas);
-    Ogl::SetTextureFilter(GL_NEAREST, GL_NEAREST);
+    return path.lexically_normal().generic_string();
 }
 
-//data pointing to the top-left pixel of the image, x & y specifying the left-bottom corner of the image area
-//if 'flip' is set the image will be flipped vertically (since opengl treats first pixel as bottom-left loaded images will be displayed upside-down)
-void WriteToAtlas(unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height, bool flip = true)
+//resource registry
+
+//doesn't query the filesystem apart from getting the working directory for relative paths
+std::string GetResourceKey(const std::filesystem::path& path)
 {
-    if (x + width > Ogl::AtlasWidth || y + height > Ogl::AtlasHeight)
-        throw std::runtime_error("Tried to write out of atlas bounds.");
+    return std::filesystem::absolute(path).lexically_normal().generic_string();
+}
 
-    for (int i = 0; i < height; i++)
-    {
-        unsigned int dataRow = flip ? height - i - 1 : i;
-        std::memcpy(
-            Ogl::AtlasData + (Ogl::AtlasWidth * (i + y) + x) * IMAGE_CHANNELS,
-            data + width * dataRow * IMAGE_CHANNELS,
-            width * IMAGE_CHANNELS);
-    }
+//returns -1 if the file hasn't been registered
+size_t Ogl::ResourceRegistry::Find(const std::filesystem::path& path)
+{
+    std::string key = GetResourceKey(path);
+    auto index = Indices.find(key);
+    if (index != Indices.end())
+        return index->second;
+
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::canonical(path, error);
+    if (error)
+        return -1;
+
+    index = Indices.find(canonical.generic_string());
+    if (index == Indices.end())
+        return -1;
+
+    //next lookups by this spelling are direct
+    Indices[key] = index->second;
+    Keys[index->second].push_back(key);
+    return index->second;
 }
 
-//writes zeroes to each channel of every pixel in the specified area
-void ZeroAtlas(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+//keys already taken by another index are left to it
+void Ogl::ResourceRegistry::Add(const std::filesystem::path& path, size_t index)
 {
-    if (x + width > Ogl::AtlasWidth || y + height > Ogl::AtlasHeight)
-        throw std::runtime_error("Tried to write out of atlas bounds.");
+    std::vector<std::string> keys = { GetResourceKey(path) };
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::canonical(path, error);
+    if (!error && canonical.generic_string() != keys[0])
+        keys.push_back(canonical.generic_string());
 
-    y = Ogl::AtlasHeight - y - height;
+    for (std::string& key : keys)
+    {
+        if (Indices.try_emplace(key, index).second)
+            Keys[index].push_back(key);
+    }
+}
 
-    for (int i = 0; i < height; i++)
+void Ogl::ResourceRegistry::Remove(size_t index)
+{
+    auto keys = Keys.find(index);
+    if (keys != Keys.end())
     {
-        std::memset(Ogl::AtlasData + (Ogl::AtlasWidth * (i + y) + x) * IMAGE_CHANNELS, 0, width * IMAGE_CHANNELS);
+        for (const std::string& key : keys->second)
+        {
+            Indices.erase(key);
+        }
+        Keys.erase(keys);
     }
+
+    References.erase(index);
 }
 
-void ResizeAtlas(unsigned int width, unsigned int height)
+//sends dimensions of textures from 'TexturesToUpdate' to GPU
+//indices are sorted & merged into contiguous ranges, small gaps are uploaded along with them to reduce the number of calls
+void UpdateTextureData()
 {
-    if (Ogl::AtlasWidth == width && Ogl::AtlasHeight == height)
+    if (Ogl::TexturesToUpdate.empty())
         return;
 
-    unsigned char* data = new unsigned char[width * height * IMAGE_CHANNELS];
+    std::vector<size_t>& indices = Ogl::TexturesToUpdate;
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
-    unsigned char* oldData = Ogl::AtlasData;
-    unsigned int oldWidth = Ogl::AtlasWidth;
-    unsigned int oldHeight = Ogl::AtlasHeight;
+    size_t requiredSsboSize = (indices.back() + 1) * sizeof(Ogl::TextureDimensions);
+    if (Ogl::Ssbo.Size < requiredSsboSize)
+        throw std::runtime_error("Out of video memory.");
 
-    Ogl::AtlasWidth = width;
-    Ogl::AtlasHeight = height;
-    Ogl::AtlasData = data;
+    size_t start = indices.front();
+    for (size_t i = 1; i <= indices.size(); i++)
+    {
+        if (i < indices.size() && indices[i] - indices[i - 1] <= TEXTURE_DATA_MAX_GAP)
+            continue;
 
-    if (oldData != NULL)
+        size_t end = indices[i - 1] + 1;
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, start * sizeof(Ogl::TextureDimensions), (end - start) * sizeof(Ogl::TextureDimensions), &Ogl::TextureDimensionsVector[start]);
+        if (i < indices.size())
+            start = indices[i];
+    }
+
+    indices.clear();
+}
+
+//replaces atlas texture array with a bigger one, previous contents are copied on GPU
+//size is at least doubled in each dimension which has to grow, so the array isn't reallocated every time a page is resized or added
+void GrowAtlasTexture(Ogl::TextureAtlas& atlas, unsigned int requiredWidth, unsigned int requiredHeight, unsigned int requiredLayers)
+{
+    int maxLayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (requiredLayers > maxLayers)
+        throw std::runtime_error(std::format("Atlas has {} pages, only {} are supported.", requiredLayers, maxLayers));
+
+    unsigned int width = atlas.TextureWidth, height = atlas.TextureHeight, layers = atlas.TextureLayers;
+    if (requiredWidth > width)
+        width = std::min(std::max(requiredWidth, width * 2), atlas.PageSize);
+    if (requiredHeight > height)
+        height = std::min(std::max(requiredHeight, height * 2), atlas.PageSize);
+    if (requiredLayers > layers)
+        layers = std::min(std::max(requiredLayers, layers * 2), static_cast<unsigned int>(maxLayers));
+
+    int minFilter, magFilter;
+    glActiveTexture(GL_TEXTURE0 + atlas.Unit);
+    glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, &minFilter);
+    glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, &magFilter);
+
+    unsigned int name;
+    glGenTextures(1, &name);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, name);
+    Ogl::SetTextureFilter(minFilter, magFilter);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, atlas.MipLevels, atlas.Compression != 0 ? atlas.Compression : atlas.StorageFormat != 0 ? atlas.StorageFormat : atlas.Format == GL_RED ? GL_R8 : GL_RGBA8, width, height, layers);
+
+    for (unsigned int level = 0; level < atlas.MipLevels && atlas.TextureWidth != 0 && atlas.TextureHeight != 0 && atlas.TextureLayers != 0; level++)
     {
-        WriteToAtlas(oldData, 0, 0, std::min(oldWidth, width), std::min(oldHeight, height), false);
-        delete[] oldData;
+        glCopyImageSubData(
+            atlas.Name, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, name, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+            atlas.TextureWidth >> level, atlas.TextureHeight >> level, atlas.TextureLayers);
     }
+
+    glDeleteTextures(1, &atlas.Name);
+    atlas.Name = name;
+    atlas.TextureWidth = width;
+    atlas.TextureHeight = height;
+    atlas.TextureLayers = layers;
+    glActiveTexture(GL_TEXTURE0);
 }
 
-//loads textures from the specified paths, adding them to atlas
-std::vector<Ogl::Texture> Ogl::LoadTextures(std::vector<std::filesystem::path> paths)
+//textures of mipmapped atlases are surrounded by gutters of their edge pixels, so filtering of the smallest level doesn't reach neighbours
+unsigned int GetAtlasGutter(const Ogl::TextureAtlas& atlas)
 {
-    if (Atlas == 0)
-        InitializeAtlas();
+    return atlas.MipLevels > 1 ? 1u << (atlas.MipLevels - 2) : 0;
+}
 
-    std::vector<Ogl::Texture> result;
+//areas of textures are made of whole blocks of compressed atlases & whole texels of the smallest mip level, so neither is shared by two textures
+unsigned int GetAtlasAlignment(const Ogl::TextureAtlas& atlas)
+{
+    return (atlas.Compression != 0 ? 4u : 1u) << (atlas.MipLevels - 1);
+}
 
-    //getting texture rects
-    for (int i = 0; i < paths.size(); i++)
+//halves 'width' x 'height' area, averaging each 2x2 square, colors are weighted by alpha so transparent pixels don't darken edges
+std::vector<unsigned char> DownsampleAtlasRegion(const Ogl::TextureAtlas& atlas, const unsigned char* pixels, size_t stride, unsigned int width, unsigned int height)
+{
+    unsigned int channels = atlas.Channels;
+    std::vector<unsigned char> result(static_cast<size_t>(width / 2) * (height / 2) * channels);
+    ParallelFor(height / 2, [&](size_t y)
     {
-        std::filesystem::path path = paths[i];
+        for (unsigned int x = 0; x < width / 2; x++)
+        {
+            const unsigned char* square[4] = {
+                pixels + stride * y * 2 + x * 2 * channels, pixels + stride * y * 2 + (x * 2 + 1) * channels,
+                pixels + stride * (y * 2 + 1) + x * 2 * channels, pixels + stride * (y * 2 + 1) + (x * 2 + 1) * channels };
+            unsigned char* pixel = result.data() + (static_cast<size_t>(width / 2) * y + x) * channels;
+
+            unsigned int alpha = channels == IMAGE_CHANNELS ? square[0][3] + square[1][3] + square[2][3] + square[3][3] : 0;
+            for (unsigned int c = 0; c < channels; c++)
+            {
+                if (c == 3 || alpha == 0)
+                {
+                    pixel[c] = (square[0][c] + square[1][c] + square[2][c] + square[3][c] + 2) / 4;
+                    continue;
+                }
+
+                unsigned int sum = square[0][c] * square[0][3] + square[1][c] * square[1][3] + square[2][c] * square[2][3] + square[3][c] * square[3][3];
+                pixel[c] = (sum + alpha / 2) / alpha;
+            }
+        }
+    });
 
-        if (!std::filesystem::exists(path))
-            throw std::runtime_error(std::format("Invalid texture path: '{}'.", path.string()));
+    return result;
+}
 
-        int width, height, components;
-        stbi_info(path.string().c_str(), &width, &height, &components);
-        AtlasPacker.Rects.push_back({ .Width = static_cast<unsigned int>(width), .Height = static_cast<unsigned int>(height), .Data = { i, 0, 0, 0 } });
+//sends a part of an atlas level to GPU, compressed atlases are updated in whole blocks, which are encoded on CPU first
+void UpdateAtlasLevel(const Ogl::TextureAtlas& atlas, unsigned int level, unsigned int page, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* pixels, size_t stride)
+{
+    if (atlas.Compression != 0)
+    {
+        std::vector<unsigned char> blocks(static_cast<size_t>(width) * height / 16 * GetCompressedBlockSize(atlas.Compression));
+        CompressRegion(atlas.Compression, pixels, stride, width, height, blocks.data());
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, x, y, page, width, height, 1, atlas.Compression, blocks.size(), blocks.data());
+        return;
     }
 
-    //packing newly generated rects & resizing the atlas
-    AtlasPacker.Pack();
-    ResizeAtlas(AtlasPacker.TotalWidth, AtlasPacker.TotalHeight);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / atlas.Channels);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, x, y, page, width, height, 1, atlas.Format, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
 
-    //loading new textures & writing them onto the atlas
-    for (Rect rect : AtlasPacker.Rects)
+//generates mip levels of a part of the atlas page on CPU & sends them to GPU, the area must consist of whole texels of the smallest level
+//'pixels' point to the left-bottom corner of the area, each level is downsampled from the previous one on all hardware threads
+void UpdateAtlasMips(const Ogl::TextureAtlas& atlas, unsigned int page, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* pixels, size_t stride)
+{
+    glActiveTexture(GL_TEXTURE0 + atlas.Unit);
+    std::vector<unsigned char> level;
+    for (unsigned int i = 1; i < atlas.MipLevels; i++)
     {
-        int rectId = get<0>(rect.Data);
-        std::filesystem::path path = paths[rectId];
+        level = DownsampleAtlasRegion(atlas, pixels, stride, width >> (i - 1), height >> (i - 1));
+        pixels = level.data();
+        stride = (width >> i) * atlas.Channels;
+        UpdateAtlasLevel(atlas, i, page, x >> i, y >> i, width >> i, height >> i, pixels, stride);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
 
-        int _;
-        unsigned char* data = stbi_load(path.string().c_str(), &_, &_, &_, IMAGE_CHANNELS);
-        if (data == NULL)
-            throw std::runtime_error(std::format("STBI error: '{}'.", stbi_failure_reason()));
+//sends a part of the atlas page to GPU, x & y specifying the left-bottom corner of the area & 'pixels' pointing to it
+//the area must consist of whole blocks of compressed atlases & texels of the smallest mip level, mip levels are generated for it if the atlas has them
+void UpdateAtlasRegion(const Ogl::TextureAtlas& atlas, unsigned int page, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* pixels, size_t stride)
+{
+    glActiveTexture(GL_TEXTURE0 + atlas.Unit);
+    UpdateAtlasLevel(atlas, 0, page, x, y, width, height, pixels, stride);
+    glActiveTexture(GL_TEXTURE0);
 
-        WriteToAtlas(data, rect.X, rect.Y, rect.Width, rect.Height);
-        delete[] data;
+    if (atlas.MipLevels > 1)
+        UpdateAtlasMips(atlas, page, x, y, width, height, pixels, stride);
+}
 
-        result.push_back(AddTexture(path, rect));
+//sends parts of the atlas written since the last upload to GPU, growing texture storage if pages have been resized or added
+//dirty rects are extended to whole blocks & texels of the smallest mip level, pixels around them are taken from the page's copy
+//atlases which don't keep their pixels upload staged areas instead, they're already aligned & dirty rects are just the same areas
+void UploadAtlas(Ogl::TextureAtlas& atlas)
+{
+    unsigned int width = 0, height = 0;
+    for (Ogl::AtlasPage& page : atlas.Pages)
+    {
+        width = std::max(width, page.Width);
+        height = std::max(height, page.Height);
     }
-    AtlasPacker.Rects.clear();
-    
-    //updating texture data array & sending everything to GPU
-    UpdateTextureData();
 
-    return result;
+    if (width > atlas.TextureWidth || height > atlas.TextureHeight || atlas.Pages.size() > atlas.TextureLayers)
+        GrowAtlasTexture(atlas, width, height, atlas.Pages.size());
+
+    unsigned int alignment = GetAtlasAlignment(atlas);
+    for (unsigned int i = 0; i < atlas.Pages.size(); i++)
+    {
+        Ogl::AtlasPage& page = atlas.Pages[i];
+        for (Rect rect : page.DirtyRects)
+        {
+            if (page.Data == NULL)
+                continue;
+
+            unsigned int right = std::min((rect.X + rect.Width + alignment - 1) / alignment * alignment, page.Width);
+            unsigned int top = std::min((rect.Y + rect.Height + alignment - 1) / alignment * alignment, page.Height);
+            unsigned int x = rect.X / alignment * alignment, y = rect.Y / alignment * alignment;
+            UpdateAtlasRegion(atlas, i, x, y, right - x, top - y, page.Data + (static_cast<size_t>(page.Width) * y + x) * atlas.Channels, page.Width * atlas.Channels);
+        }
+
+        for (const Ogl::StagedArea& staged : page.StagedAreas)
+        {
+            Rect area = staged.Area;
+            UpdateAtlasRegion(atlas, i, area.X, area.Y, area.Width, area.Height, staged.Pixels.data(), area.Width * atlas.Channels);
+        }
+
+        page.DirtyRects.clear();
+        page.StagedAreas.clear();
+    }
 }
 
-//barebones BDF font loader
-Ogl::BitmapFont Ogl::LoadBdfFont(std::filesystem::path path)
+void InitializeAtlas(Ogl::TextureAtlas& atlas)
 {
-    BitmapFont result = {};
+    int maxSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    atlas.PageSize = std::min(ATLAS_PAGE_SIZE, maxSize);
 
-    if (Atlas == 0)
-        InitializeAtlas();
+    if (atlas.MipLevels == 0 || atlas.MipLevels > 16 || GetAtlasAlignment(atlas) > atlas.PageSize)
+        throw std::runtime_error(std::format("Atlas can't have {} mip levels.", atlas.MipLevels));
 
-    if (!std::filesystem::exists(path))
-        throw std::runtime_error(std::format("Invalid font path: '{}'.", path.string()));
+    if (atlas.Compression != 0)
+    {
+        if (atlas.Format != GL_RGBA)
+            throw std::runtime_error("Only RGBA atlases can be compressed.");
+
+        //BC7 is a part of opengl 4.2, BC1 & BC3 come from an extension
+        bool isSupported = atlas.Compression == ATLAS_COMPRESSION_BC7;
+        int extensionCount;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (int i = 0; i < extensionCount && !isSupported; i++)
+        {
+            isSupported = std::strcmp(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)), "GL_EXT_texture_compression_s3tc") == 0;
+        }
 
-    std::fstream file = std::fstream(path, std::ios::in | std::ios::binary);
-    if (!file.is_open())
-        throw std::runtime_error(std::format("Failed to open font file: '{}'.", path.string()));
+        if (!isSupported)
+            throw std::runtime_error(std::format("Atlas compression format {} isn't supported.", atlas.Compression));
+    }
 
-    //reading glyph data
-    //'Rect' data is used for storing encoding, bitmap starting byte, x offset, y offset (in that order)
-    std::string line;
-    const int maxOffset = 256; //max x/y offset
-    int code, width, height, offsetX, offsetY;
-    while (!file.eof())
-    {
-        std::getline(file, line);
+    glGenTextures(1, &atlas.Name);
+    glActiveTexture(GL_TEXTURE0 + atlas.Unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.Name);
+    Ogl::SetTextureFilter(atlas.MipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST, GL_NEAREST); //mip levels are blended when minifying, magnified pixels stay sharp
+    glActiveTexture(GL_TEXTURE0);
+}
 
-        //font end
-        if (line.rfind("ENDFONT") == 0)
-            break;
+//writes the image & it's gutters into the area it takes in atlas, 'pixels' pointing to the left-bottom corner of the area, see 'GetAtlasArea'
+//data pointing to the top-left pixel of the image, x & y specifying the left-bottom corner of the image in the page
+//if 'flip' is set the image will be flipped vertically (since opengl treats first pixel as bottom-left loaded images will be displayed upside-down)
+//if 'rotate' is set the image is written with x & y swapped, taking 'height' x 'width' area, see 'TEXTURE_FLAG_ROTATED'
+void WriteToArea(const Ogl::TextureAtlas& atlas, unsigned char* pixels, size_t stride, unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height, bool flip, bool rotate)
+{
+    Rect area = GetAtlasArea(atlas, { x, y, width, height, rotate });
+    auto pixel = [&](unsigned int column, unsigned int row) { return pixels + stride * (row - area.Y) + static_cast<size_t>(column - area.X) * atlas.Channels; };
 
-        //new glyph
-        if (line.rfind("STARTCHAR") == 0)
-            AtlasPacker.Rects.emplace_back();
+    for (int i = 0; i < height; i++)
+    {
+        unsigned int dataRow = flip ? height - i - 1 : i;
+        if (!rotate)
+        {
+            std::memcpy(pixel(x, i + y), data + static_cast<size_t>(width) * dataRow * atlas.Channels, width * atlas.Channels);
+            continue;
+        }
 
-        //settings glyph's encoding
-        if (line.rfind("ENCODING") == 0)
+        //row of the image becomes a column of the atlas
+        for (unsigned int j = 0; j < width; j++)
         {
-            sscanf(line.substr(8).data(), "%d", &code);
-            get<0>(AtlasPacker.Rects.back().Data) = code;
+            std::memcpy(pixel(x + i, j + y), data + (static_cast<size_t>(width) * dataRow + j) * atlas.Channels, atlas.Channels);
         }
+    }
 
-        //glyph's bitmap size & offsets
-        if (line.rfind("BBX") == 0)
+    //extruding edge pixels into the gutter & padding around the image
+    unsigned int right = x + (rotate ? height : width), top = y + (rotate ? width : height);
+    for (unsigned int row = y; row < top && (area.X < x || area.X + area.Width > right); row++)
+    {
+        for (unsigned int column = area.X; column < x; column++)
+        {
+            std::memcpy(pixel(column, row), pixel(x, row), atlas.Channels);
+        }
+        for (unsigned int column = right; column < area.X + area.Width; column++)
         {
-            Rect& glyphRect = AtlasPacker.Rects.back();
-            sscanf(line.substr(3).data(), "%d %d %d %d", &width, &height, &offsetX, &offsetY);
+            std::memcpy(pixel(column, row), pixel(right - 1, row), atlas.Channels);
+        }
+    }
 
-            if (offsetX > maxOffset || offsetY > maxOffset)
-                throw std::runtime_error("Glyph X/Y offset is too high.");
+    for (unsigned int row = area.Y; row < area.Y + area.Height; row++)
+    {
+        if (row < y || row >= top)
+            std::memcpy(pixel(area.X, row), pixel(area.X, std::clamp(row, y, top - 1)), area.Width * atlas.Channels);
+    }
+}
 
-            glyphRect.Width = width + std::abs(offsetX), 
-            glyphRect.Height = height + std::abs(offsetY);
+std::mutex StagedAreasMutex; //images are written into atlas on all hardware threads, see 'WriteImagesToAtlas'
 
-            if (glyphRect.Width > result.MaxWidth)
-                result.MaxWidth = glyphRect.Width;
+//writes the image into the page's copy, or stages it's area until the next upload if the atlas doesn't keep it's pixels, see 'WriteToArea'
+void WriteToAtlas(Ogl::TextureAtlas& atlas, unsigned int page, unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height, bool flip, bool rotate)
+{
+    Ogl::AtlasPage& atlasPage = atlas.Pages[page];
+    if (x + (rotate ? height : width) > atlasPage.Width || y + (rotate ? width : height) > atlasPage.Height)
+        throw std::runtime_error("Tried to write out of atlas bounds.");
 
-            if (glyphRect.Height > result.MaxHeight)
-                result.MaxHeight = glyphRect.Height;
+    Rect area = GetAtlasArea(atlas, { x, y, width, height, rotate });
+    if (atlas.KeepPixels)
+    {
+        unsigned char* pixels = atlasPage.Data + (static_cast<size_t>(atlasPage.Width) * area.Y + area.X) * atlas.Channels;
+        WriteToArea(atlas, pixels, atlasPage.Width * atlas.Channels, data, x, y, width, height, flip, rotate);
+        return;
+    }
 
-            get<2>(glyphRect.Data) = std::max(-offsetX, 0);
-            get<3>(glyphRect.Data) = std::max(-offsetY, 0);
-        }
+    //padding of compressed blocks is encoded along with textures, so it's cleared
+    //moving the vector into the page keeps it's buffer, so it's written after the lock is released
+    std::vector<unsigned char> staged(static_cast<size_t>(area.Width) * area.Height * atlas.Channels);
+    unsigned char* pixels = staged.data();
+    {
+        std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(StagedAreasMutex);
+        atlasPage.StagedAreas.push_back({ area, std::move(staged) });
+    }
+    WriteToArea(atlas, pixels, area.Width * atlas.Channels, data, x, y, width, height, flip, rotate);
+}
+
+//returns the area taken by the rect in atlas, width & height of rotated rects are swapped
+//the area includes gutters of mipmapped atlases & is rounded up to 'GetAtlasAlignment', the rect is placed 'GetAtlasGutter' pixels from it's left-bottom corner
+Rect GetAtlasArea(const Ogl::TextureAtlas& atlas, Rect rect)
+{
+    if (rect.IsRotated)
+        std::swap(rect.Width, rect.Height);
+    rect.IsRotated = false;
+
+    unsigned int gutter = GetAtlasGutter(atlas), alignment = GetAtlasAlignment(atlas);
+    rect.X -= gutter;
+    rect.Y -= gutter;
+    rect.Width = (rect.Width + gutter * 2 + alignment - 1) / alignment * alignment;
+    rect.Height = (rect.Height + gutter * 2 + alignment - 1) / alignment * alignment;
+    return rect;
+}
+
+Rect GetTextureRect(Ogl::TextureDimensions dimensions)
+{
+    return { dimensions.X, dimensions.Y, dimensions.Width, dimensions.Height, (dimensions.Flags & TEXTURE_FLAG_ROTATED) != 0, dimensions.Page };
+}
 
-        //glyph's bitmap
-        if (line.rfind("BITMAP") == 0)
-            get<1>(AtlasPacker.Rects.back().Data) = file.tellg();
+void ResizeAtlasPage(Ogl::TextureAtlas& atlas, unsigned int page, unsigned int width, unsigned int height)
+{
+    Ogl::AtlasPage& atlasPage = atlas.Pages[page];
+    if (atlasPage.Width == width && atlasPage.Height == height)
+        return;
+
+    //texture storage is grown by 'UploadAtlas', copying the pages on GPU
+    if (!atlas.KeepPixels)
+    {
+        atlasPage.Width = width;
+        atlasPage.Height = height;
+        return;
     }
 
-    //packing glyph rects to atlas & resizing it
-    AtlasPacker.Pack();
-    ResizeAtlas(AtlasPacker.TotalWidth, AtlasPacker.TotalHeight);
+    //padding of compressed blocks is encoded along with textures, so it's cleared
+    size_t size = static_cast<size_t>(width) * height * atlas.Channels;
+    unsigned char* data = atlas.Compression != 0 ? new unsigned char[size]() : new unsigned char[size];
 
-    //writing bitmaps to atlas & setting encoding ranges
-    size_t rangeStartIndex = 0;
-    bool firstGlyph = true;
-    unsigned int rangeStartCodepoint = 0;
-    unsigned int prevCodepoint = 0;
+    unsigned char* oldData = atlasPage.Data;
+    unsigned int oldWidth = atlasPage.Width;
+    unsigned int oldHeight = atlasPage.Height;
 
-    //sorting by encoding
-    std::sort(AtlasPacker.Rects.begin(), AtlasPacker.Rects.end(), [](Rect rect1, Rect rect2) { return get<0>(rect1.Data) < get<0>(rect2.Data); });
+    atlasPage.Width = width;
+    atlasPage.Height = height;
+    atlasPage.Data = data;
 
-    for (Rect rect : AtlasPacker.Rects)
+    if (oldData != NULL)
     {
-        unsigned int currentCodepoint = get<0>(rect.Data);
+        for (unsigned int i = 0; i < std::min(oldHeight, height); i++)
+        {
+            std::memcpy(data + static_cast<size_t>(width) * i * atlas.Channels, oldData + static_cast<size_t>(oldWidth) * i * atlas.Channels, std::min(oldWidth, width) * atlas.Channels);
+        }
+        delete[] oldData;
+    }
+}
+
+//places the rect into the smallest free rect it fits into (rotating it if the atlas allows it), the rest of the free rect is split in two along the longer leftover side
+bool PackIntoFreeRect(Ogl::TextureAtlas& atlas, Rect& rect)
+{
+    Ogl::AtlasPage* selectedPage = NULL;
+    size_t selectedIndex = 0;
+    bool isRotated = false;
+    size_t minArea = std::numeric_limits<size_t>().max();
+    Rect required = GetAtlasArea(atlas, { .Width = rect.Width, .Height = rect.Height });
 
-        if (firstGlyph || currentCodepoint != prevCodepoint + 1)
+    for (Ogl::AtlasPage& page : atlas.Pages)
+    {
+        for (size_t i = 0; i < page.FreeRects.size(); i++)
         {
-            if (firstGlyph)
-            {
-                firstGlyph = false;
-            }
-            else 
+            Rect freeRect = page.FreeRects[i];
+            size_t area = static_cast<size_t>(freeRect.Width) * freeRect.Height;
+            bool fits = freeRect.Width >= required.Width && freeRect.Height >= required.Height;
+            bool fitsRotated = atlas.AllowRotation && freeRect.Width >= required.Height && freeRect.Height >= required.Width;
+            if ((fits || fitsRotated) && area < minArea)
             {
-                result.EncodingRanges.push_back({ rangeStartCodepoint, prevCodepoint, rangeStartIndex });
+                selectedPage = &page;
+                selectedIndex = i;
+                isRotated = !fits;
+                minArea = area;
             }
-
-            rangeStartCodepoint = currentCodepoint;
-            rangeStartIndex = Textures.size();
         }
+    }
 
-        prevCodepoint = currentCodepoint;
+    if (selectedPage == NULL)
+        return false;
 
-        ZeroAtlas(rect.X, rect.Y, rect.Width, rect.Height); //to avoid random garbage on edges of glyphs with non-zero offsets
-        file.seekg(get<1>(rect.Data)); //going to the start of the bitmap
+    Rect freeRect = selectedPage->FreeRects[selectedIndex];
+    selectedPage->FreeRects.erase(selectedPage->FreeRects.begin() + selectedIndex);
+    rect.X = freeRect.X + GetAtlasGutter(atlas);
+    rect.Y = freeRect.Y + GetAtlasGutter(atlas);
+    rect.IsRotated = isRotated;
+    rect.Page = selectedPage - atlas.Pages.data();
 
-        unsigned char buffer[IMAGE_CHANNELS * 4]; //4 cause we're writing up to 4 pixels per hexadecimal digit
-        int offsetX = get<2>(rect.Data);
-        int offsetY = get<3>(rect.Data);
+    Rect area = GetAtlasArea(atlas, rect);
+    unsigned int rightWidth = freeRect.Width - area.Width;
+    unsigned int topHeight = freeRect.Height - area.Height;
+    bool isSplitVertical = rightWidth > topHeight; //the right part takes the whole height of the free rect
+    Rect right = { .X = freeRect.X + area.Width, .Y = freeRect.Y, .Width = rightWidth, .Height = isSplitVertical ? freeRect.Height : area.Height };
+    Rect top = { .X = freeRect.X, .Y = freeRect.Y + area.Height, .Width = isSplitVertical ? area.Width : freeRect.Width, .Height = topHeight };
 
-        for (int y = rect.Height - offsetY - 1; y > 0; y--)
-        {
-            std::getline(file, line);
+    for (Rect part : { right, top })
+    {
+        if (part.Width != 0 && part.Height != 0)
+            selectedPage->FreeRects.push_back(part);
+    }
 
-            for (int x = 0; x < line.length(); x++)
-            {
-                char character = line[x];
-                if (character < '0') //ignoring whitespaces
-                    continue;
+    return true;
+}
 
-                unsigned char value = character < '9' ? character - '0' : character - 'A' + 10; //hexadecimal digit to 4 bit value
+//finds places for rects in atlas pages, setting their positions, pages & rotation, new pages are added once existing ones are full
+//areas of unloaded textures are reused first, then each page is packed independently
+void PackAtlas(Ogl::TextureAtlas& atlas, std::vector<Rect>& rects)
+{
+    std::vector<Rect> remaining;
+    for (size_t i = 0; i < rects.size(); i++)
+    {
+        if (rects[i].Width == 0 || rects[i].Height == 0)
+            continue; //empty rects don't take any space
+
+        rects[i].IsRotated = false;
+        Rect area = GetAtlasArea(atlas, rects[i]);
+        if (area.Width > atlas.PageSize || area.Height > atlas.PageSize)
+            throw std::runtime_error(std::format("Texture of size {}x{} doesn't fit into atlas page of size {}.", rects[i].Width, rects[i].Height, atlas.PageSize));
+
+        if (PackIntoFreeRect(atlas, rects[i]))
+            atlas.Pages[rects[i].Page].UsedPixels += static_cast<size_t>(area.Width) * area.Height;
+        else
+            remaining.push_back({ .Width = area.Width, .Height = area.Height, .Data = { static_cast<long>(i), 0, 0, 0 } });
+    }
 
-                int pixels = rect.Width - offsetX - x * 4;
-                pixels = std::max(std::min(pixels, 4), 0); //how much pixels we have to actually write
+    for (unsigned int page = 0; !remaining.empty(); page++)
+    {
+        if (page == atlas.Pages.size())
+            atlas.Pages.push_back({ .Packer = { .Strategy = atlas.Strategy, .MaxWidth = atlas.PageSize, .MaxHeight = atlas.PageSize } });
 
-                for (int i = 0; i < pixels; i++)
-                {
-                    *reinterpret_cast<unsigned int*>(buffer + i * IMAGE_CHANNELS) = value & (0b1000 >> i) ? 0xFFFFFFFF : 0;
-                }
+        RectanglePacker& packer = atlas.Pages[page].Packer;
+        packer.AllowRotation = atlas.AllowRotation;
+        packer.Rects = remaining;
+        remaining = packer.Pack();
 
-                if (pixels != 0)
-                    WriteToAtlas(buffer, rect.X + offsetX + x * 4, y, pixels, 1);
-            }
+        for (Rect rect : packer.Rects)
+        {
+            Rect& result = rects[get<0>(rect.Data)];
+            result.X = rect.X + GetAtlasGutter(atlas);
+            result.Y = rect.Y + GetAtlasGutter(atlas);
+            result.IsRotated = rect.IsRotated;
+            result.Page = page;
+            atlas.Pages[page].UsedPixels += static_cast<size_t>(rect.Width) * rect.Height;
         }
+        packer.Rects.clear();
 
-        AddTexture(path, rect);
+        ResizeAtlasPage(atlas, page, packer.TotalWidth, packer.TotalHeight);
     }
+}
 
-    result.Path = path;
-    result.GlyphCount = AtlasPacker.Rects.size();
-    result.EncodingRanges.push_back({ rangeStartCodepoint, prevCodepoint, rangeStartIndex });
+//returns the rect to the page's free rects, merging it with free neighbours sharing a whole edge
+void FreeAtlasRect(Ogl::TextureAtlas& atlas, Rect rect)
+{
+    Ogl::AtlasPage& page = atlas.Pages[rect.Page];
+    page.UsedPixels -= static_cast<size_t>(rect.Width) * rect.Height;
 
-    file.close();
-    AtlasPacker.Rects.clear();
-    UpdateTextureData();
+    for (size_t i = 0; i < page.FreeRects.size();)
+    {
+        Rect other = page.FreeRects[i];
+        bool isHorizontal = other.Y == rect.Y && other.Height == rect.Height && (other.X + other.Width == rect.X || rect.X + rect.Width == other.X);
+        bool isVertical = other.X == rect.X && other.Width == rect.Width && (other.Y + other.Height == rect.Y || rect.Y + rect.Height == other.Y);
+        if (!isHorizontal && !isVertical)
+        {
+            i++;
+            continue;
+        }
 
-    return result;
+        rect.X = std::min(rect.X, other.X);
+        rect.Y = std::min(rect.Y, other.Y);
+        rect.Width = isHorizontal ? rect.Width + other.Width : rect.Width;
+        rect.Height = isVertical ? rect.Height + other.Height : rect.Height;
+        page.FreeRects.erase(page.FreeRects.begin() + i);
+        i = 0; //the merged rect may now share an edge with rects checked before
+    }
+
+    page.FreeRects.push_back(rect);
 }
 
-//loads all the textures from the specified path (recursively)
-std::vector<Ogl::Texture> Ogl::LoadTexturesFromPath(std::filesystem::path path)
+//image ingest
+//images are trimmed to their non transparent pixels & hashed before packing, so duplicates can share a single area
+
+//image decoded by 'WriteImagesToAtlas'
+struct AtlasImage
 {
-    std::vector<std::filesystem::path> paths;
+    Rect Region; //stored part of the image in atlas
+    unsigned int OffsetX = 0; //position of the stored part in the image from it's left-bottom corner
+    unsigned int OffsetY = 0;
+    unsigned int Width = 0; //size of the whole image
+    unsigned int Height = 0;
+    unsigned long long Hash = 0; //hash of stored pixels, zero if the atlas doesn't share duplicates
+    bool IsDuplicate = false; //takes the area of another image, so nothing has been written
+};
+
+//returns the smallest rect containing all pixels of the image which aren't fully transparent, x & y specifying it's top-left corner
+//rows of 'pixels' go from top to bottom, a fully transparent image is trimmed to it's top-left pixel
+Rect GetOpaqueBounds(const unsigned char* pixels, unsigned int width, unsigned int height)
+{
+    auto isOpaque = [&](unsigned int column, unsigned int row) { return pixels[(static_cast<size_t>(width) * row + column) * IMAGE_CHANNELS + 3] != 0; };
+    auto isRowOpaque = [&](unsigned int row)
+    {
+        for (unsigned int column = 0; column < width; column++)
+        {
+            if (isOpaque(column, row))
+                return true;
+        }
+        return false;
+    };
 
-    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(path))
+    unsigned int top = 0, bottom = height;
+    while (top < height && !isRowOpaque(top))
+        top++;
+
+    if (top == height)
+        return { .Width = 1, .Height = 1 };
+
+    while (!isRowOpaque(bottom - 1))
+        bottom--;
+
+    //columns are only searched up to the bounds found in previous rows
+    unsigned int left = width, right = 0;
+    for (unsigned int row = top; row < bottom; row++)
     {
-        std::string ext = entry.path().extension().string();
-        for (std::string imageExt : IMAGE_EXTS)
+        for (unsigned int column = 0; column < left; column++)
         {
-            if (ext == imageExt)
-                paths.push_back(entry.path());
+            if (isOpaque(column, row))
+                left = column;
+        }
+        for (unsigned int column = width; column > right; column--)
+        {
+            if (isOpaque(column - 1, row))
+                right = column;
         }
     }
 
-    return LoadTextures(paths);
+    return { .X = left, .Y = top, .Width = right - left, .Height = bottom - top };
+}
+
+//64 bit FNV-1a of the image's size & pixels
+unsigned long long HashImage(const unsigned char* pixels, unsigned int width, unsigned int height)
+{
+    unsigned long long hash = 0xCBF29CE484222325;
+    auto add = [&](const unsigned char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ data[i]) * 0x100000001B3;
+        }
+    };
+
+    add(reinterpret_cast<const unsigned char*>(&width), sizeof(width));
+    add(reinterpret_cast<const unsigned char*>(&height), sizeof(height));
+    add(pixels, static_cast<size_t>(width) * height * IMAGE_CHANNELS);
+    return hash;
 }
 
-//finds texture by path if it's already loaded/loads it if not
-Ogl::Texture Ogl::ResolveTexture(std::filesystem::path path)
+//checks whether the image (top-left pixel first) is stored in the rect of the page's copy, the inverse of 'WriteToArea' with 'flip' set
+//baked pages of compressed atlases hold decoded blocks, which rarely match the image exactly, so it's usually stored again
+bool IsWrittenToAtlas(const Ogl::TextureAtlas& atlas, Rect rect, const unsigned char* data, unsigned int width, unsigned int height)
 {
-    if (std::filesystem::exists(path))
+    const Ogl::AtlasPage& atlasPage = atlas.Pages[rect.Page];
+    if (atlasPage.Data == NULL || rect.Width != width || rect.Height != height)
+        return false;
+
+    for (unsigned int row = 0; row < height; row++)
     {
-        for (int i = 1; i < Textures.size(); i++)
+        const unsigned char* dataRow = data + static_cast<size_t>(width) * (height - row - 1) * atlas.Channels;
+        if (!rect.IsRotated)
+        {
+            if (std::memcmp(atlasPage.Data + (static_cast<size_t>(atlasPage.Width) * (rect.Y + row) + rect.X) * atlas.Channels, dataRow, width * atlas.Channels) != 0)
+                return false;
+            continue;
+        }
+
+        for (unsigned int column = 0; column < width; column++)
         {
-            Texture& texture = Textures[i];
-            if (std::filesystem::equivalent(texture.Path, path))
-                return texture;
+            if (std::memcmp(atlasPage.Data + (static_cast<size_t>(atlasPage.Width) * (rect.Y + column) + rect.X + row) * atlas.Channels, dataRow + column * atlas.Channels, atlas.Channels) != 0)
+                return false;
         }
     }
 
-    return LoadTextures({ path })[0];
+    return true;
 }
 
-//finds font by path if it's already loaded/loads it if not
-Ogl::BitmapFont Ogl::ResolveFont(std::filesystem::path path)
+//decodes images from the specified paths, packs them into atlas pages & writes them there without sending anything to GPU, returned images are in the same order as paths
+//files are mapped, decoded, trimmed & hashed on all hardware threads, then rects are packed & images are written in parallel, decoded images are kept in RAM until then
+//duplicates aren't packed, they take the area of an earlier image with the same hash & identical pixels, images already in the image atlas are only found if it keeps it's pixels
+std::vector<AtlasImage> WriteImagesToAtlas(Ogl::TextureAtlas& atlas, const std::vector<std::filesystem::path>& paths)
 {
-    if (std::filesystem::exists(path))
+    //decoding images & trimming them in place, so stored rows follow each other
+    std::vector<AtlasImage> images(paths.size());
+    std::vector<std::unique_ptr<unsigned char, void (*)(void*)>> pixels;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        pixels.emplace_back(nullptr, stbi_image_free);
+    }
+
+    ParallelFor(paths.size(), [&](size_t i)
     {
-        for (BitmapFont& font : Fonts)
+        if (!std::filesystem::exists(paths[i]))
+            throw std::runtime_error(std::format("Invalid texture path: '{}'.", paths[i].string()));
+
+        int width, height, _;
+        {
+            MappedFile file = MappedFile(paths[i]);
+            pixels[i].reset(stbi_load_from_memory(reinterpret_cast<const unsigned char*>(file.Data), file.Size, &width, &height, &_, IMAGE_CHANNELS));
+        }
+        if (pixels[i] == NULL)
+            throw std::runtime_error(std::format("STBI error: '{}'.", stbi_failure_reason()));
+
+        AtlasImage& image = images[i];
+        image.Width = width;
+        image.Height = height;
+
+        unsigned char* data = pixels[i].get();
+        Rect bounds = atlas.TrimImages ? GetOpaqueBounds(data, image.Width, image.Height) : Rect { .Width = image.Width, .Height = image.Height };
+        for (unsigned int row = 0; row < bounds.Height && (bounds.Width != image.Width || bounds.Height != image.Height); row++)
+        {
+            std::memmove(
+                data + static_cast<size_t>(bounds.Width) * row * IMAGE_CHANNELS,
+                data + (static_cast<size_t>(image.Width) * (bounds.Y + row) + bounds.X) * IMAGE_CHANNELS,
+                bounds.Width * IMAGE_CHANNELS);
+        }
+
+        image.Region = { .Width = bounds.Width, .Height = bounds.Height };
+        image.OffsetX = bounds.X;
+        image.OffsetY = image.Height - bounds.Y - bounds.Height;
+        if (atlas.ShareDuplicates)
+            image.Hash = HashImage(data, bounds.Width, bounds.Height);
+    });
+
+    //finding duplicates & packing the rest, resizing atlas pages
+    //hashes only narrow down candidates, pixels are compared since different images may collide
+    std::unordered_map<unsigned long long, std::vector<size_t>> storedImages; //indices of packed images with each hash
+    std::vector<size_t> originals(images.size(), SIZE_MAX); //index of the packed image each duplicate shares
+    std::vector<size_t> packed; //indices of images in 'rects'
+    std::vector<Rect> rects;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        AtlasImage& image = images[i];
+        if (image.Hash != 0)
         {
-            if (std::filesystem::equivalent(font.Path, path))
-                return font;
+            auto shared = Ogl::Textures.SharedContents.find(image.Hash);
+            if (&atlas == &Ogl::Atlas && atlas.KeepPixels && shared != Ogl::Textures.SharedContents.end())
+            {
+                for (size_t index : shared->second)
+                {
+                    Rect rect = GetTextureRect(Ogl::TextureDimensionsVector[index]);
+                    if (IsWrittenToAtlas(atlas, rect, pixels[i].get(), image.Region.Width, image.Region.Height))
+                    {
+                        image.Region = rect;
+                        image.IsDuplicate = true;
+                        break;
+                    }
+                }
+                if (image.IsDuplicate)
+                    continue;
+            }
+
+            std::vector<size_t>& candidates = storedImages[image.Hash];
+            for (size_t candidate : candidates)
+            {
+                const AtlasImage& original = images[candidate];
+                if (original.Region.Width == image.Region.Width && original.Region.Height == image.Region.Height &&
+                    std::memcmp(pixels[candidate].get(), pixels[i].get(), static_cast<size_t>(image.Region.Width) * image.Region.Height * IMAGE_CHANNELS) == 0)
+                {
+                    originals[i] = candidate;
+                    image.IsDuplicate = true;
+                    break;
+                }
+            }
+            if (image.IsDuplicate)
+                continue;
+            candidates.push_back(i);
         }
+
+        packed.push_back(i);
+        rects.push_back(image.Region);
+    }
+
+    PackAtlas(atlas, rects);
+    for (size_t i = 0; i < packed.size(); i++)
+    {
+        images[packed[i]].Region = rects[i];
+    }
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        if (originals[i] != SIZE_MAX)
+            images[i].Region = images[originals[i]].Region;
+    }
+
+    //writing images onto the atlas, rects don't overlap so it's done in parallel
+    ParallelFor(packed.size(), [&](size_t i)
+    {
+        Rect rect = images[packed[i]].Region;
+        WriteToAtlas(atlas, rect.Page, pixels[packed[i]].get(), rect.X, rect.Y, rect.Width, rect.Height, true, rect.IsRotated);
+        pixels[packed[i]].reset();
+    });
+
+    return images;
+}
+
+//returns indices of images sharing the texture's area (including it) in the order they were added, images with the same hash may still be stored in different areas
+//(e.g. if they've been baked separately), just the texture's index if it isn't shared
+std::vector<size_t> GetSharingTextures(size_t index)
+{
+    auto hash = Ogl::Textures.ContentHashes.find(index);
+    if (hash == Ogl::Textures.ContentHashes.end())
+        return { index };
+
+    Ogl::TextureDimensions dimensions = Ogl::TextureDimensionsVector[index];
+    std::vector<size_t> result;
+    for (size_t sharing : Ogl::Textures.SharedContents[hash->second])
+    {
+        Ogl::TextureDimensions sharingDimensions = Ogl::TextureDimensionsVector[sharing];
+        if (sharingDimensions.X == dimensions.X && sharingDimensions.Y == dimensions.Y && sharingDimensions.Page == dimensions.Page)
+            result.push_back(sharing);
+    }
+    return result;
+}
+
+//adds a texture of an image from 'WriteImagesToAtlas' or a baked atlas, registering it's hash, see 'GetSharingTextures'
+Ogl::TextureHandle AddImageTexture(const AtlasImage& image, std::filesystem::path path)
+{
+    bool isTrimmed = image.Region.Width != image.Width || image.Region.Height != image.Height;
+    Ogl::TextureHandle texture = AddTexture(image.Region, isTrimmed ? TEXTURE_FLAG_TRIMMED : 0, path);
+
+    Ogl::TextureDimensions& dimensions = Ogl::TextureDimensionsVector[texture.Index];
+    dimensions.OffsetX = image.OffsetX;
+    dimensions.OffsetY = image.OffsetY;
+    dimensions.SourceWidth = image.Width;
+    dimensions.SourceHeight = image.Height;
+
+    if (image.Hash != 0)
+    {
+        Ogl::Textures.SharedContents[image.Hash].push_back(texture.Index);
+        Ogl::Textures.ContentHashes[texture.Index] = image.Hash;
+    }
+    return texture;
+}
+
+//loads textures from the specified paths, adding them to atlas, returned textures are in the same order as paths
+std::vector<Ogl::TextureHandle> Ogl::LoadTextures(std::vector<std::filesystem::path> paths)
+{
+    if (Atlas.Name == 0)
+        InitializeAtlas(Atlas);
+
+    std::vector<AtlasImage> images = WriteImagesToAtlas(Atlas, paths);
+    for (const AtlasImage& image : images)
+    {
+        if (!image.IsDuplicate)
+            Atlas.Pages[image.Region.Page].DirtyRects.push_back(GetAtlasArea(Atlas, image.Region));
+    }
+
+    std::vector<Ogl::TextureHandle> result;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        result.push_back(AddImageTexture(images[i], paths[i]));
+        TextureRegistry.Add(paths[i], result.back().Index);
     }
+    
+    //updating texture data array & sending everything to GPU
+    UpdateTextureData();
+    UploadAtlas(Atlas);
+
+    return result;
+}
+
+//asynchronous texture streaming
+//textures are decoded by background threads, then written into atlas by the render thread & uploaded through a ring of pixel buffers
+//only 'TextureStreamingBudget' bytes are uploaded per frame, textures keep pointing at the placeholder until they're fully uploaded
+
+struct DecodedTexture
+{
+    size_t Index = 0;
+    int Width = 0;
+    int Height = 0;
+    unsigned char* Data = NULL; //allocated by stbi, NULL if decoding has failed
+};
+
+struct TextureUpload
+{
+    size_t Index = 0;
+    Rect Region; //not swapped for rotated textures & not rounded to blocks of compressed atlases, see 'GetAtlasArea'
+    unsigned int UploadedRows = 0;
+    std::vector<unsigned char> Pixels; //area of the texture, staged here until it's fully uploaded if the atlas doesn't keep it's pixels
+};
 
-    return LoadBdfFont(path);
+struct PixelBuffer
+{
+    unsigned int Name = 0;
+    size_t Size = 0;
+    GLsync Fence = NULL; //signaled once the last upload from the buffer has finished
+};
+
+//decoded textures are handed over to the render thread through 'DecodedTextures', so it must outlive the workers
+std::mutex DecodedTexturesMutex;
+std::vector<DecodedTexture> DecodedTextures;
+TaskQueue TextureDecodingTasks;
+
+std::deque<TextureUpload> TextureUploads;
+std::unordered_set<size_t> StreamingTextures; //indices of textures which aren't resident yet
+PixelBuffer PixelBuffers[PIXEL_BUFFER_COUNT];
+size_t NextPixelBuffer = 0;
+size_t PlaceholderTexture = 0;
+
+//2x2 magenta & black checkerboard shown in place of textures which are still loading
+void AddPlaceholderTexture()
+{
+    const unsigned int pixels[4] = { 0xFFFF00FF, 0xFF000000, 0xFF000000, 0xFFFF00FF };
+
+    std::vector<Rect> rects = { { .Width = 2, .Height = 2 } };
+    PackAtlas(Ogl::Atlas, rects);
+    Rect rect = rects[0];
+
+    WriteToAtlas(Ogl::Atlas, rect.Page, reinterpret_cast<unsigned char*>(const_cast<unsigned int*>(pixels)), rect.X, rect.Y, 2, 2);
+    Ogl::Atlas.Pages[rect.Page].DirtyRects.push_back(GetAtlasArea(Ogl::Atlas, rect));
+    PlaceholderTexture = AddTexture(rect).Index;
+    UpdateTextureData();
+    UploadAtlas(Ogl::Atlas);
+}
+
+//returns a handle of the texture immediately, it's displayed as a placeholder until it's decoded & uploaded by background threads & 'UpdateTextureStreaming'
+Ogl::TextureHandle Ogl::LoadTextureAsync(std::filesystem::path path)
+{
+    if (Atlas.Name == 0)
+        InitializeAtlas(Atlas);
+
+    if (!std::filesystem::exists(path))
+        throw std::runtime_error(std::format("Invalid texture path: '{}'.", path.string()));
+
+    if (PlaceholderTexture == 0)
+        AddPlaceholderTexture();
+
+    TextureDimensions placeholder = TextureDimensionsVector[PlaceholderTexture];
+    TextureHandle texture = AddTexture({ .X = placeholder.X, .Y = placeholder.Y, .Width = placeholder.Width, .Height = placeholder.Height, .Page = placeholder.Page }, 0, path);
+    UpdateTextureData();
+    StreamingTextures.insert(texture.Index);
+    TextureRegistry.Add(path, texture.Index); //so the texture is resolved while it's still loading instead of being loaded twice
+
+    TextureDecodingTasks.Submit([index = texture.Index, path]()
+    {
+        DecodedTexture decoded = { .Index = index };
+        int _;
+        decoded.Data = stbi_load(path.string().c_str(), &decoded.Width, &decoded.Height, &_, IMAGE_CHANNELS);
+        if (decoded.Data == NULL)
+            Log(std::format("Failed to load texture '{}': '{}'.\n", path.string(), stbi_failure_reason()));
+
+        std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(DecodedTexturesMutex);
+        DecodedTextures.push_back(decoded);
+    });
+
+    return texture;
+}
+
+//same as 'ResolveTexture', but loads the texture with 'LoadTextureAsync', textures which are still loading are found as well
+Ogl::TextureHandle Ogl::ResolveTextureAsync(std::filesystem::path path)
+{
+    size_t index = TextureRegistry.Find(path);
+    TextureHandle texture = index != -1 ? Textures.GetHandle(index) : LoadTextureAsync(path);
+    TextureRegistry.References[texture.Index]++;
+    return texture;
+}
+
+//returns false if the texture is still being loaded by 'LoadTextureAsync'
+bool Ogl::IsTextureResident(TextureHandle texture)
+{
+    return !StreamingTextures.contains(texture.Index);
+}
+
+//returns pixels of the upload's area, either from the page's copy or staged by the upload itself
+const unsigned char* GetUploadPixels(const TextureUpload& upload, size_t& stride)
+{
+    Rect area = GetAtlasArea(Ogl::Atlas, upload.Region);
+    if (!upload.Pixels.empty())
+    {
+        stride = area.Width * IMAGE_CHANNELS;
+        return upload.Pixels.data();
+    }
+
+    const Ogl::AtlasPage& page = Ogl::Atlas.Pages[area.Page];
+    stride = page.Width * IMAGE_CHANNELS;
+    return page.Data + (static_cast<size_t>(page.Width) * area.Y + area.X) * IMAGE_CHANNELS;
+}
+
+void CompleteTextureUpload(const TextureUpload& upload)
+{
+    Ogl::TextureDimensionsVector[upload.Index] = { upload.Region.X, upload.Region.Y, upload.Region.Width, upload.Region.Height, upload.Region.IsRotated ? TEXTURE_FLAG_ROTATED : 0u, upload.Region.Page, 0, 0, 0, upload.Region.Width, upload.Region.Height };
+    Ogl::TexturesToUpdate.push_back(upload.Index);
+    StreamingTextures.erase(upload.Index);
+}
+
+//called by the update loop before drawing each frame
+void UpdateTextureStreaming()
+{
+    std::vector<DecodedTexture> decodedTextures;
+    {
+        std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(DecodedTexturesMutex);
+        decodedTextures.swap(DecodedTextures);
+    }
+
+    //packing decoded textures, the texture storage is grown before rows are uploaded into it
+    std::vector<Rect> rects;
+    for (DecodedTexture& decoded : decodedTextures)
+    {
+        if (decoded.Data == NULL)
+        {
+            StreamingTextures.erase(decoded.Index); //failed textures are left with the placeholder
+            continue;
+        }
+
+        rects.push_back({ .Width = static_cast<unsigned int>(decoded.Width), .Height = static_cast<unsigned int>(decoded.Height) });
+    }
+
+    if (!rects.empty())
+    {
+        PackAtlas(Ogl::Atlas, rects);
+        UploadAtlas(Ogl::Atlas);
+    }
+
+    size_t rectIndex = 0;
+    for (DecodedTexture& decoded : decodedTextures)
+    {
+        if (decoded.Data == NULL)
+            continue;
+
+        Rect rect = rects[rectIndex++];
+        TextureUpload upload = { .Index = decoded.Index, .Region = rect };
+        if (Ogl::Atlas.KeepPixels)
+        {
+            WriteToAtlas(Ogl::Atlas, rect.Page, decoded.Data, rect.X, rect.Y, rect.Width, rect.Height, true, rect.IsRotated);
+        }
+        else
+        {
+            Rect area = GetAtlasArea(Ogl::Atlas, rect);
+            upload.Pixels.resize(static_cast<size_t>(area.Width) * area.Height * IMAGE_CHANNELS);
+            WriteToArea(Ogl::Atlas, upload.Pixels.data(), area.Width * IMAGE_CHANNELS, decoded.Data, rect.X, rect.Y, rect.Width, rect.Height, true, rect.IsRotated);
+        }
+        stbi_image_free(decoded.Data);
+        TextureUploads.push_back(std::move(upload));
+    }
+
+    //uploading rows of pending textures through the pixel buffer ring until the budget runs out
+    //at least a single row is uploaded per frame, so textures with rows larger than the budget still get uploaded
+    //rows of compressed atlases are rows of blocks, they're encoded straight into the pixel buffer
+    const Ogl::TextureAtlas& atlas = Ogl::Atlas;
+    unsigned int rowHeight = atlas.Compression != 0 ? 4 : 1;
+    size_t budget = Ogl::TextureStreamingBudget;
+    bool isFirstUpload = true;
+    std::vector<TextureUpload> completedUploads; //mip levels are generated once the pixel buffer is unbound
+    glActiveTexture(GL_TEXTURE0 + Ogl::Atlas.Unit);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    while (!TextureUploads.empty())
+    {
+        TextureUpload& upload = TextureUploads.front();
+        Rect area = GetAtlasArea(atlas, upload.Region);
+        size_t rowSize = atlas.Compression != 0 ? area.Width / 4 * GetCompressedBlockSize(atlas.Compression) : static_cast<size_t>(area.Width) * IMAGE_CHANNELS;
+        unsigned int rows = std::min(static_cast<unsigned int>(budget / std::max(rowSize, static_cast<size_t>(1))), (area.Height - upload.UploadedRows) / rowHeight);
+        if (rows == 0 && !isFirstUpload)
+            break;
+        rows = std::max(rows, 1u);
+
+        //buffers still used by the GPU aren't waited for
+        PixelBuffer& buffer = PixelBuffers[NextPixelBuffer];
+        if (buffer.Fence != NULL)
+        {
+            if (glClientWaitSync(buffer.Fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                break;
+            glDeleteSync(buffer.Fence);
+            buffer.Fence = NULL;
+        }
+
+        if (buffer.Name == 0)
+            glGenBuffers(1, &buffer.Name);
+
+        size_t size = rowSize * rows;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.Name);
+        if (buffer.Size < size)
+        {
+            buffer.Size = std::max(size, Ogl::TextureStreamingBudget);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer.Size, NULL, GL_STREAM_DRAW);
+        }
+
+        unsigned char* data = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        size_t stride;
+        const unsigned char* pixels = GetUploadPixels(upload, stride) + stride * upload.UploadedRows;
+        unsigned int y = area.Y + upload.UploadedRows;
+        if (atlas.Compression != 0)
+        {
+            CompressRegion(atlas.Compression, pixels, stride, area.Width, rows * rowHeight, data);
+        }
+        else
+        {
+            for (unsigned int i = 0; i < rows; i++)
+            {
+                std::memcpy(data + rowSize * i, pixels + stride * i, rowSize);
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        if (atlas.Compression != 0)
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, area.X, y, area.Page, area.Width, rows * rowHeight, 1, atlas.Compression, size, NULL);
+        else
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, area.X, y, area.Page, area.Width, rows, 1, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        buffer.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        NextPixelBuffer = (NextPixelBuffer + 1) % PIXEL_BUFFER_COUNT;
+
+        budget -= std::min(budget, size);
+        isFirstUpload = false;
+        upload.UploadedRows += rows * rowHeight;
+        if (upload.UploadedRows == area.Height)
+        {
+            CompleteTextureUpload(upload);
+            completedUploads.push_back(std::move(upload));
+            TextureUploads.pop_front();
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    for (const TextureUpload& upload : completedUploads)
+    {
+        Rect area = GetAtlasArea(atlas, upload.Region);
+        size_t stride;
+        const unsigned char* pixels = GetUploadPixels(upload, stride);
+        if (atlas.MipLevels > 1)
+            UpdateAtlasMips(atlas, area.Page, area.X, area.Y, area.Width, area.Height, pixels, stride);
+    }
+
+    UpdateTextureData();
+}
+
+//returns paths of all the images in the specified directory (recursively)
+std::vector<std::filesystem::path> GetImagePaths(std::filesystem::path path)
+{
+    std::vector<std::filesystem::path> paths;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(path))
+    {
+        std::string ext = entry.path().extension().string();
+        for (std::string imageExt : IMAGE_EXTS)
+        {
+            if (ext == imageExt)
+                paths.push_back(entry.path());
+        }
+    }
+
+    return paths;
+}
+
+//loads all the textures from the specified path (recursively)
+std::vector<Ogl::TextureHandle> Ogl::LoadTexturesFromPath(std::filesystem::path path)
+{
+    return LoadTextures(GetImagePaths(path));
+}
+
+//finds texture by path if it's already loaded/loads it if not, textures from baked atlases are found by paths they had while being baked
+//each call adds a reference to the texture, see 'ReleaseTexture'
+Ogl::TextureHandle Ogl::ResolveTexture(std::filesystem::path path)
+{
+    size_t index = TextureRegistry.Find(path);
+    TextureHandle texture = index != -1 ? Textures.GetHandle(index) : LoadTextures({ path })[0];
+    TextureRegistry.References[texture.Index]++;
+    return texture;
+}
+
+//removes a reference added by 'ResolveTexture'/'ResolveTextureAsync', the texture is unloaded once none are left
+void Ogl::ReleaseTexture(TextureHandle texture)
+{
+    auto references = TextureRegistry.References.find(texture.Index);
+    if (references == TextureRegistry.References.end())
+        throw std::runtime_error("Tried to release a texture which hasn't been resolved.");
+
+    if (--references->second == 0)
+        UnloadTexture(texture);
+}
+
+//dynamic textures
+//they're stored in an atlas of their format, which isn't compressed, mipmapped or kept in RAM, & are updated straight from memory through an orphaned pixel buffer
+
+unsigned int DynamicPixelBuffer = 0;
+std::unordered_map<size_t, Ogl::DynamicTextureFormat> DynamicTextureFormats; //keyed by texture index
+
+//returns the atlas of a dynamic texture with the specified flags, the shader picks it's sampler by them as well
+Ogl::TextureAtlas& GetDynamicAtlas(unsigned int flags)
+{
+    if ((flags & TEXTURE_FLAG_HALF_FLOAT) != 0)
+        return Ogl::DynamicR16FAtlas;
+    return (flags & TEXTURE_FLAG_SCALAR) != 0 ? Ogl::DynamicR8Atlas : Ogl::DynamicAtlas;
+}
+
+//returns a texture with undefined contents until it's updated by 'UpdateDynamicTexture', it's unloaded by 'UnloadTexture'
+//scalar textures are color mapped through 'palette' (any non glyph texture, it's bottom row is used), they're drawn as grayscale if it's invalid
+Ogl::TextureHandle Ogl::CreateDynamicTexture(unsigned int width, unsigned int height, DynamicTextureFormat format, TextureHandle palette)
+{
+    if (width == 0 || height == 0)
+        throw std::runtime_error("Dynamic texture can't be empty.");
+
+    unsigned int flags = TEXTURE_FLAG_DYNAMIC;
+    if (format != DynamicTextureFormat::RGBA8)
+        flags |= TEXTURE_FLAG_SCALAR;
+    if (format == DynamicTextureFormat::R16F)
+        flags |= TEXTURE_FLAG_HALF_FLOAT;
+
+    TextureAtlas& atlas = GetDynamicAtlas(flags);
+    if (atlas.Name == 0)
+        InitializeAtlas(atlas);
+
+    std::vector<Rect> rects = { { .Width = width, .Height = height } };
+    PackAtlas(atlas, rects);
+    UploadAtlas(atlas);
+
+    TextureHandle texture = AddTexture(rects[0], flags);
+    DynamicTextureFormats[texture.Index] = format;
+    if (format != DynamicTextureFormat::RGBA8)
+        SetTexturePalette(texture, palette);
+    return texture;
+}
+
+//replaces all pixels of a dynamic texture, 'pixels' are in texture's format & rows go from bottom to top
+//each update is a single upload from a pixel buffer whose storage is orphaned first, so writing it never waits for the GPU to finish the previous upload from it
+void Ogl::UpdateDynamicTexture(TextureHandle texture, const void* pixels)
+{
+    auto format = DynamicTextureFormats.find(texture.Index);
+    if (!Textures.IsValid(texture) || format == DynamicTextureFormats.end())
+        throw std::runtime_error("Tried to update an invalid dynamic texture.");
+
+    TextureDimensions dimensions = TextureDimensionsVector[texture.Index];
+    auto [pixelFormat, type, pixelSize] =
+        format->second == DynamicTextureFormat::RGBA8 ? std::tuple(GL_RGBA, GL_UNSIGNED_BYTE, 4) :
+        format->second == DynamicTextureFormat::R8 ? std::tuple(GL_RED, GL_UNSIGNED_BYTE, 1) :
+        std::tuple(GL_RED, GL_HALF_FLOAT, 2);
+    size_t size = static_cast<size_t>(dimensions.Width) * dimensions.Height * pixelSize;
+
+    if (DynamicPixelBuffer == 0)
+        glGenBuffers(1, &DynamicPixelBuffer);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, DynamicPixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    void* data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT);
+    std::memcpy(data, pixels, size);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glActiveTexture(GL_TEXTURE0 + GetDynamicAtlas(dimensions.Flags).Unit);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, dimensions.X, dimensions.Y, dimensions.Page, dimensions.Width, dimensions.Height, 1, pixelFormat, type, NULL);
+    glActiveTexture(GL_TEXTURE0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+//sets the palette a scalar dynamic texture is color mapped through, see 'CreateDynamicTexture'
+void Ogl::SetTexturePalette(TextureHandle texture, TextureHandle palette)
+{
+    if (!Textures.IsValid(texture) || (TextureDimensionsVector[texture.Index].Flags & TEXTURE_FLAG_SCALAR) == 0)
+        throw std::runtime_error("Only scalar dynamic textures have palettes.");
+
+    if (palette.Index != 0 && (!Textures.IsValid(palette) || (TextureDimensionsVector[palette.Index].Flags & TEXTURE_FLAG_GLYPH) != 0))
+        throw std::runtime_error("Palette must be a valid image or dynamic texture.");
+
+    TextureDimensionsVector[texture.Index].Palette = palette.Index;
+    TexturesToUpdate.push_back(texture.Index);
+    UpdateTextureData();
+}
+
+//sprite sheets
+//frames of a sheet are sub-textures pointing into the rect of it's image, so they take no space in atlas & aren't decoded separately
+//frames of mipmapped atlases aren't separated by gutters, so the smallest levels of neighbouring frames blend together
+
+//returns a texture showing the 'width' x 'height' area of the texture, x & y specifying the area's top-left corner in the image
+//it's unloaded along with the texture, unloading it doesn't free anything in atlas
+Ogl::TextureHandle Ogl::CreateSubTexture(TextureHandle texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    if (!Textures.IsValid(texture))
+        throw std::runtime_error("Tried to create a sub-texture of an invalid texture.");
+
+    TextureDimensions dimensions = TextureDimensionsVector[texture.Index];
+    if ((dimensions.Flags & TEXTURE_FLAG_GLYPH) != 0)
+        throw std::runtime_error("Glyph textures can't have sub-textures.");
+
+    if (StreamingTextures.contains(texture.Index))
+        throw std::runtime_error("Can't create a sub-texture of a texture which is still being loaded.");
+
+    if (width == 0 || height == 0 || x + width > dimensions.SourceWidth || y + height > dimensions.SourceHeight)
+        throw std::runtime_error(std::format("Sub-texture {}x{} at {}, {} doesn't fit into a {}x{} texture.", width, height, x, y, dimensions.SourceWidth, dimensions.SourceHeight));
+
+    //the area is intersected with the stored part of the texture (which is all of it unless it's trimmed), rows of the atlas go from bottom to top
+    unsigned int bottom = dimensions.SourceHeight - y - height;
+    unsigned int left = std::max(x, dimensions.OffsetX), right = std::min(x + width, dimensions.OffsetX + dimensions.Width);
+    unsigned int lower = std::max(bottom, dimensions.OffsetY), upper = std::min(bottom + height, dimensions.OffsetY + dimensions.Height);
+    bool isEmpty = left >= right || lower >= upper;
+    if (isEmpty)
+    {
+        left = dimensions.OffsetX;
+        right = left + 1;
+        lower = dimensions.OffsetY;
+        upper = lower + 1;
+    }
+
+    //rotated textures are stored with x & y swapped
+    unsigned int storedX = left - dimensions.OffsetX, storedY = lower - dimensions.OffsetY;
+    bool isRotated = (dimensions.Flags & TEXTURE_FLAG_ROTATED) != 0;
+    Rect rect = {
+        .X = dimensions.X + (isRotated ? storedY : storedX),
+        .Y = dimensions.Y + (isRotated ? storedX : storedY),
+        .Width = right - left,
+        .Height = upper - lower,
+        .IsRotated = isRotated,
+        .Page = dimensions.Page
+    };
+    bool isTrimmed = rect.Width != width || rect.Height != height;
+
+    //sub-textures of sub-textures point into the same texture, so only it's rect is ever moved or freed
+    auto parent = Textures.Parents.find(texture.Index);
+    size_t parentIndex = parent != Textures.Parents.end() ? parent->second : texture.Index;
+
+    //a fully transparent area still stores a single pixel, it's placed outside of the sub-texture so it's never drawn
+    TextureHandle subTexture = AddTexture(rect, (dimensions.Flags & ~(TEXTURE_FLAG_ROTATED | TEXTURE_FLAG_TRIMMED)) | (isTrimmed ? TEXTURE_FLAG_TRIMMED : 0));
+    TextureDimensions& subDimensions = TextureDimensionsVector[subTexture.Index];
+    subDimensions.Palette = dimensions.Palette;
+    subDimensions.OffsetX = isEmpty ? width + 1 : left - x;
+    subDimensions.OffsetY = isEmpty ? 0 : lower - bottom;
+    subDimensions.SourceWidth = width;
+    subDimensions.SourceHeight = height;
+
+    Textures.Parents[subTexture.Index] = parentIndex;
+    Textures.SubTextures[parentIndex].push_back(subTexture.Index);
+    UpdateTextureData();
+    return subTexture;
+}
+
+//splits the texture into a grid of 'cellWidth' x 'cellHeight' sub-textures, returned in rows from the top-left one
+//cells start 'margin' pixels from the texture's top-left corner & are 'spacing' pixels apart, only the first 'count' are created unless it's zero
+std::vector<Ogl::TextureHandle> Ogl::SplitTexture(TextureHandle texture, unsigned int cellWidth, unsigned int cellHeight, size_t count, unsigned int margin, unsigned int spacing)
+{
+    if (!Textures.IsValid(texture))
+        throw std::runtime_error("Tried to split an invalid texture.");
+
+    if (cellWidth == 0 || cellHeight == 0)
+        throw std::runtime_error("Sprite sheet cells can't be empty.");
+
+    TextureDimensions dimensions = TextureDimensionsVector[texture.Index];
+    size_t columns = dimensions.SourceWidth >= margin + cellWidth ? (dimensions.SourceWidth - margin - cellWidth) / (cellWidth + spacing) + 1 : 0;
+    size_t rows = dimensions.SourceHeight >= margin + cellHeight ? (dimensions.SourceHeight - margin - cellHeight) / (cellHeight + spacing) + 1 : 0;
+    if (count == 0)
+        count = columns * rows;
+
+    if (count > columns * rows)
+        throw std::runtime_error(std::format("Texture has only {} cells, {} requested.", columns * rows, count));
+
+    std::vector<TextureHandle> cells;
+    cells.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        unsigned int x = margin + static_cast<unsigned int>(i % columns) * (cellWidth + spacing);
+        unsigned int y = margin + static_cast<unsigned int>(i / columns) * (cellHeight + spacing);
+        cells.push_back(CreateSubTexture(texture, x, y, cellWidth, cellHeight));
+    }
+    return cells;
+}
+
+//loads a sprite sheet described by a JSON file in the hash or array format of TexturePacker/Aseprite ('frames' & 'meta.image' relative to the file)
+//the image is resolved by 'ResolveTexture', frames are created by 'CreateSubTexture' from their 'frame' rects
+//trimmed frames are drawn as their trimmed rects, rotated ones aren't supported since they're stored turned rather than with x & y swapped
+Ogl::SpriteSheet Ogl::LoadSpriteSheet(std::filesystem::path path)
+{
+    if (!std::filesystem::exists(path))
+        throw std::runtime_error(std::format("Invalid sprite sheet path: '{}'.", path.string()));
+
+    JsonValue root;
+    {
+        MappedFile file = MappedFile(path);
+        root = ParseJson(std::string_view(file.Data, file.Size));
+    }
+
+    const JsonValue& image = root.Get("meta").Get("image");
+    const JsonValue& frames = root.Get("frames");
+    if (image.Kind != JsonValue::Type::String || (frames.Kind != JsonValue::Type::Object && frames.Kind != JsonValue::Type::Array))
+        throw std::runtime_error(std::format("Invalid sprite sheet: '{}'.", path.string()));
+
+    //frames of the hash format are keyed by their names, those of the array format have a 'filename'
+    std::vector<std::pair<std::string, const JsonValue*>> namedFrames;
+    for (const auto& [name, frame] : frames.Object)
+    {
+        namedFrames.emplace_back(name, &frame);
+    }
+    for (const JsonValue& frame : frames.Array)
+    {
+        const JsonValue* name = frame.Find("filename");
+        namedFrames.emplace_back(name != NULL ? name->String : std::string(), &frame);
+    }
+
+    SpriteSheet sheet = { .Texture = ResolveTexture(path.parent_path() / image.String) };
+    for (const auto& [name, frame] : namedFrames)
+    {
+        const JsonValue* rotated = frame->Find("rotated");
+        if (rotated != NULL && rotated->Bool)
+            throw std::runtime_error(std::format("Frame '{}' of sprite sheet '{}' is rotated, which isn't supported.", name, path.string()));
+
+        const JsonValue& rect = frame->Get("frame");
+        TextureHandle texture = CreateSubTexture(
+            sheet.Texture,
+            static_cast<unsigned int>(rect.GetNumber("x", 0.0)),
+            static_cast<unsigned int>(rect.GetNumber("y", 0.0)),
+            static_cast<unsigned int>(rect.GetNumber("w", 0.0)),
+            static_cast<unsigned int>(rect.GetNumber("h", 0.0)));
+        sheet.Frames.push_back(texture);
+        sheet.FrameNames[name] = texture;
+    }
+
+    return sheet;
+}
+
+//texture unloading & atlas compaction
+
+bool IsAtlasFragmented = false; //set once a texture is unloaded, checked by 'UpdateAtlasCompaction'
+
+//frees texture's area in atlas so it can be reused by other images
+//the index is reused as well, so the handle mustn't be used afterwards
+void Ogl::UnloadTexture(TextureHandle texture)
+{
+    if (!Textures.IsValid(texture))
+        throw std::runtime_error("Tried to unload an invalid texture.");
+
+    TextureDimensions dimensions = TextureDimensionsVector[texture.Index];
+    if ((dimensions.Flags & TEXTURE_FLAG_GLYPH) != 0)
+        throw std::runtime_error("Glyph textures are owned by their fonts and can't be unloaded.");
+
+    if (StreamingTextures.contains(texture.Index))
+        throw std::runtime_error("Can't unload a texture which is still being loaded.");
+
+    //sub-textures only point into their parent's area, which is freed along with all of them
+    //areas shared by duplicates are freed along with the last of them
+    TextureAtlas& atlas = (dimensions.Flags & TEXTURE_FLAG_DYNAMIC) != 0 ? GetDynamicAtlas(dimensions.Flags) : Atlas;
+    auto parent = Textures.Parents.find(texture.Index);
+    bool isAreaFreed = parent == Textures.Parents.end() && GetSharingTextures(texture.Index).size() == 1 && dimensions.Width != 0 && dimensions.Height != 0;
+    if (parent != Textures.Parents.end())
+    {
+        std::vector<size_t>& siblings = Textures.SubTextures[parent->second];
+        std::erase(siblings, texture.Index);
+        if (siblings.empty())
+            Textures.SubTextures.erase(parent->second);
+        Textures.Parents.erase(parent);
+    }
+    else
+    {
+        auto subTextures = Textures.SubTextures.find(texture.Index);
+        if (subTextures != Textures.SubTextures.end())
+        {
+            std::vector<size_t> indices = std::move(subTextures->second);
+            Textures.SubTextures.erase(subTextures);
+            for (size_t index : indices)
+            {
+                UnloadTexture(Textures.GetHandle(index));
+            }
+        }
+
+        if (isAreaFreed)
+            FreeAtlasRect(atlas, GetAtlasArea(atlas, GetTextureRect(dimensions)));
+    }
+    DynamicTextureFormats.erase(texture.Index);
+
+    auto hash = Textures.ContentHashes.find(texture.Index);
+    if (hash != Textures.ContentHashes.end())
+    {
+        std::vector<size_t>& shared = Textures.SharedContents[hash->second];
+        std::erase(shared, texture.Index);
+        if (shared.empty())
+            Textures.SharedContents.erase(hash->second);
+        Textures.ContentHashes.erase(hash);
+    }
+
+    Textures.Paths.erase(texture.Index);
+    TextureRegistry.Remove(texture.Index);
+
+    TextureDimensionsVector[texture.Index] = {};
+    TexturesToUpdate.push_back(texture.Index);
+    UpdateTextureData();
+
+    Textures.Generations[texture.Index]++;
+    FreeTextureIndices.push_back(texture.Index);
+    IsAtlasFragmented = IsAtlasFragmented || (&atlas == &Atlas && isAreaFreed);
+}
+
+//repacks loaded images into new pages, moving them with 'glCopyImageSubData' & updating their dimensions, so handles stay valid
+//only the image atlas is compacted, fonts rely on positions of their glyphs & dynamic textures are rarely unloaded
+void Ogl::CompactAtlas()
+{
+    if (Atlas.Name == 0)
+        return;
+
+    if (!StreamingTextures.empty())
+        throw std::runtime_error("Can't compact atlas while textures are being loaded.");
+
+    UploadAtlas(Atlas);
+
+    //each area is moved once along with all images sharing it, they're found before any of them is moved
+    std::vector<std::vector<size_t>> indices;
+    std::vector<Rect> rects;
+    for (size_t i = 1; i < TextureDimensionsVector.size(); i++)
+    {
+        TextureDimensions dimensions = TextureDimensionsVector[i];
+        if ((dimensions.Flags & (TEXTURE_FLAG_GLYPH | TEXTURE_FLAG_DYNAMIC)) != 0 || dimensions.Width == 0 || dimensions.Height == 0 || Textures.Parents.contains(i))
+            continue;
+
+        std::vector<size_t> sharing = GetSharingTextures(i);
+        if (sharing.front() != i)
+            continue;
+
+        Rect area = GetAtlasArea(Atlas, GetTextureRect(dimensions));
+        indices.push_back(std::move(sharing));
+        rects.push_back({ .Width = area.Width, .Height = area.Height });
+    }
+
+    //textures are copied as they're stored along with their gutters & mip levels, so they can't be rotated again
+    //whole areas are packed without gutters, they stay aligned since all of their sizes are, then the atlas takes mip levels of the current one
+    //the new texture array takes filters of the current one, since it's bound to the same unit
+    TextureAtlas compacted = {
+        .Unit = Atlas.Unit, .Format = Atlas.Format, .Channels = Atlas.Channels, .PageSize = Atlas.PageSize, .Strategy = Atlas.Strategy, .Compression = Atlas.Compression,
+        .KeepPixels = Atlas.KeepPixels, .TrimImages = Atlas.TrimImages, .ShareDuplicates = Atlas.ShareDuplicates
+    };
+    PackAtlas(compacted, rects);
+    compacted.MipLevels = Atlas.MipLevels;
+    UploadAtlas(compacted);
+    compacted.AllowRotation = Atlas.AllowRotation;
+
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        Rect area = GetAtlasArea(Atlas, GetTextureRect(TextureDimensionsVector[indices[i].front()]));
+        Rect rect = rects[i];
+        for (unsigned int level = 0; level < Atlas.MipLevels; level++)
+        {
+            glCopyImageSubData(
+                Atlas.Name, GL_TEXTURE_2D_ARRAY, level, area.X >> level, area.Y >> level, area.Page,
+                compacted.Name, GL_TEXTURE_2D_ARRAY, level, rect.X >> level, rect.Y >> level, rect.Page,
+                rect.Width >> level, rect.Height >> level, 1);
+        }
+
+        AtlasPage& source = Atlas.Pages[area.Page];
+        AtlasPage& destination = compacted.Pages[rect.Page];
+        for (unsigned int row = 0; row < rect.Height && Atlas.KeepPixels; row++)
+        {
+            std::memcpy(
+                destination.Data + (static_cast<size_t>(destination.Width) * (rect.Y + row) + rect.X) * Atlas.Channels,
+                source.Data + (static_cast<size_t>(source.Width) * (area.Y + row) + area.X) * Atlas.Channels,
+                rect.Width * Atlas.Channels);
+        }
+
+        //sub-textures keep their offsets from the texture
+        for (size_t index : indices[i])
+        {
+            TextureDimensions& dimensions = TextureDimensionsVector[index];
+            unsigned int x = dimensions.X, y = dimensions.Y;
+            dimensions.X = rect.X + GetAtlasGutter(Atlas);
+            dimensions.Y = rect.Y + GetAtlasGutter(Atlas);
+            dimensions.Page = rect.Page;
+            TexturesToUpdate.push_back(index);
+
+            auto subTextures = Textures.SubTextures.find(index);
+            if (subTextures == Textures.SubTextures.end())
+                continue;
+
+            for (size_t subIndex : subTextures->second)
+            {
+                TextureDimensions& subDimensions = TextureDimensionsVector[subIndex];
+                subDimensions.X = subDimensions.X - x + dimensions.X;
+                subDimensions.Y = subDimensions.Y - y + dimensions.Y;
+                subDimensions.Page = rect.Page;
+                TexturesToUpdate.push_back(subIndex);
+            }
+        }
+    }
+
+    for (AtlasPage& page : Atlas.Pages)
+    {
+        delete[] page.Data;
+    }
+    glDeleteTextures(1, &Atlas.Name);
+
+    Log(std::format("Compacted atlas from {} to {} pages.\n", Atlas.Pages.size(), compacted.Pages.size()));
+    Atlas = compacted;
+    UpdateTextureData();
+}
+
+//called by the update loop between frames, compacts the image atlas once enough of it is unused after unloading textures
+void UpdateAtlasCompaction()
+{
+    if (!IsAtlasFragmented || Ogl::AtlasCompactionThreshold == 0.0f || !StreamingTextures.empty())
+        return;
+
+    IsAtlasFragmented = false;
+    if (1.0f - Ogl::GetAtlasMetrics(Ogl::Atlas).Occupancy >= Ogl::AtlasCompactionThreshold)
+        Ogl::CompactAtlas();
+}
+
+Ogl::AtlasMetrics Ogl::GetAtlasMetrics(const TextureAtlas& atlas)
+{
+    AtlasMetrics metrics = { .PageCount = atlas.Pages.size() };
+    size_t largestFreeRect = 0;
+
+    for (const AtlasPage& page : atlas.Pages)
+    {
+        metrics.TotalPixels += static_cast<size_t>(page.Width) * page.Height;
+        metrics.UsedPixels += page.UsedPixels;
+        for (Rect rect : page.FreeRects)
+        {
+            size_t area = static_cast<size_t>(rect.Width) * rect.Height;
+            metrics.FreePixels += area;
+            largestFreeRect = std::max(largestFreeRect, area);
+        }
+    }
+
+    if (metrics.TotalPixels != 0)
+        metrics.Occupancy = static_cast<float>(metrics.UsedPixels) / metrics.TotalPixels;
+    if (metrics.FreePixels != 0)
+        metrics.Fragmentation = 1.0f - static_cast<float>(largestFreeRect) / metrics.FreePixels;
+
+    return metrics;
+}
+
+//reads the first level of the whole texture array back from GPU, layers follow each other & rows go from bottom to top
+//compressed atlases are decompressed by the driver
+std::vector<unsigned char> ReadAtlasTexture(const Ogl::TextureAtlas& atlas)
+{
+    std::vector<unsigned char> pixels(static_cast<size_t>(atlas.TextureWidth) * atlas.TextureHeight * atlas.TextureLayers * atlas.Channels);
+    glActiveTexture(GL_TEXTURE0 + atlas.Unit);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, atlas.Format, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glActiveTexture(GL_TEXTURE0);
+    return pixels;
+}
+
+//writes every page of the atlas into a png file named '<path>_<page index>.png'
+//pages of atlases which don't keep their pixels are read back from GPU
+void Ogl::DumpAtlas(const TextureAtlas& atlas, std::filesystem::path path)
+{
+    std::vector<unsigned char> texture;
+    if (!atlas.KeepPixels)
+        texture = ReadAtlasTexture(atlas);
+
+    stbi_flip_vertically_on_write(true); //pages store rows from bottom to top
+    for (size_t i = 0; i < atlas.Pages.size(); i++)
+    {
+        const AtlasPage& page = atlas.Pages[i];
+        std::string pagePath = std::format("{}_{}.png", path.string(), i);
+        const unsigned char* pixels = atlas.KeepPixels ? page.Data : texture.data() + static_cast<size_t>(atlas.TextureWidth) * atlas.TextureHeight * i * atlas.Channels;
+        size_t stride = (atlas.KeepPixels ? page.Width : atlas.TextureWidth) * atlas.Channels;
+        if (!stbi_write_png(pagePath.c_str(), page.Width, page.Height, atlas.Channels, pixels, stride))
+            throw std::runtime_error(std::format("Failed to write atlas page to '{}'.", pagePath));
+    }
+    stbi_flip_vertically_on_write(false);
+}
+
+//baked atlases
+//format: header, pages, textures, paths of textures (without terminating zeros), page pixels
+//pixels of each page are either raw rows from bottom to top or compressed blocks of all mip levels, depending on 'Compression'
+
+#define BAKED_ATLAS_VERSION 3
+
+struct BakedAtlasHeader
+{
+    char Magic[4] = { 'O', 'G', 'L', 'A' };
+    unsigned int Version = BAKED_ATLAS_VERSION;
+    unsigned int Compression = 0;
+    unsigned int MipLevels = 1;
+    unsigned int PageCount = 0;
+    unsigned int TextureCount = 0;
+    unsigned int PathsSize = 0;
+};
+
+struct BakedAtlasPage
+{
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+    unsigned long long Offset = 0; //from the start of the file
+    unsigned long long Size = 0;
+};
+
+struct BakedAtlasTexture
+{
+    unsigned int X = 0;
+    unsigned int Y = 0;
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+    unsigned int IsRotated = 0;
+    unsigned int Page = 0;
+    unsigned int PathOffset = 0; //from the start of paths
+    unsigned int PathSize = 0;
+    unsigned int OffsetX = 0; //see 'AtlasImage'
+    unsigned int OffsetY = 0;
+    unsigned int SourceWidth = 0;
+    unsigned int SourceHeight = 0;
+    unsigned long long Hash = 0; //duplicates have the same rect & hash
+};
+
+//packs all the images from the specified directory (recursively) & writes them into a single file loaded by 'LoadBakedAtlas'
+//doesn't require an opengl context, pages are packed the same way as the image atlas (with it's mip levels) & are compressed if 'compression' isn't zero
+void Ogl::BakeAtlas(std::filesystem::path path, std::filesystem::path output, unsigned int compression)
+{
+    std::vector<std::filesystem::path> paths = GetImagePaths(path);
+    std::sort(paths.begin(), paths.end()); //directory order is unspecified, sorting keeps baked files reproducible
+
+    TextureAtlas atlas = {
+        .PageSize = ATLAS_PAGE_SIZE, .AllowRotation = Atlas.AllowRotation, .Compression = compression, .MipLevels = Atlas.MipLevels,
+        .KeepPixels = true, .TrimImages = Atlas.TrimImages, .ShareDuplicates = Atlas.ShareDuplicates
+    };
+    std::vector<AtlasImage> images = WriteImagesToAtlas(atlas, paths);
+
+    BakedAtlasHeader header = { .Compression = compression, .MipLevels = atlas.MipLevels, .PageCount = static_cast<unsigned int>(atlas.Pages.size()), .TextureCount = static_cast<unsigned int>(paths.size()) };
+    std::vector<BakedAtlasTexture> textures;
+    std::string texturePaths;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        const AtlasImage& image = images[i];
+        Rect rect = image.Region;
+        std::string key = GetBakedTextureKey(paths[i]);
+        textures.push_back({
+            rect.X, rect.Y, rect.Width, rect.Height, rect.IsRotated, rect.Page, static_cast<unsigned int>(texturePaths.size()), static_cast<unsigned int>(key.size()),
+            image.OffsetX, image.OffsetY, image.Width, image.Height, image.Hash
+        });
+        texturePaths += key;
+    }
+    header.PathsSize = texturePaths.size();
+
+    std::vector<BakedAtlasPage> pages;
+    std::vector<std::vector<unsigned char>> pixels;
+    size_t offset = sizeof(BakedAtlasHeader) + atlas.Pages.size() * sizeof(BakedAtlasPage) + textures.size() * sizeof(BakedAtlasTexture) + texturePaths.size();
+    for (AtlasPage& page : atlas.Pages)
+    {
+        size_t size = static_cast<size_t>(page.Width) * page.Height * atlas.Channels;
+        if (compression != 0)
+        {
+            //compressed levels can't be generated at load time, since pixels aren't available then
+            pixels.emplace_back();
+            std::vector<unsigned char> level;
+            const unsigned char* levelPixels = page.Data;
+            for (unsigned int i = 0; i < atlas.MipLevels; i++)
+            {
+                unsigned int width = page.Width >> i, height = page.Height >> i;
+                if (i != 0)
+                {
+                    level = DownsampleAtlasRegion(atlas, levelPixels, (width * 2) * atlas.Channels, width * 2, height * 2);
+                    levelPixels = level.data();
+                }
+
+                size_t offset = pixels.back().size();
+                pixels.back().resize(offset + static_cast<size_t>(width) * height / 16 * GetCompressedBlockSize(compression));
+                CompressRegion(compression, levelPixels, width * atlas.Channels, width, height, pixels.back().data() + offset);
+            }
+            size = pixels.back().size();
+        }
+
+        pages.push_back({ page.Width, page.Height, offset, size });
+        offset += size;
+    }
+
+    std::ofstream file = std::ofstream(output, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(BakedAtlasHeader));
+    file.write(reinterpret_cast<const char*>(pages.data()), pages.size() * sizeof(BakedAtlasPage));
+    file.write(reinterpret_cast<const char*>(textures.data()), textures.size() * sizeof(BakedAtlasTexture));
+    file.write(texturePaths.data(), texturePaths.size());
+    for (size_t i = 0; i < atlas.Pages.size(); i++)
+    {
+        const char* data = compression != 0 ? reinterpret_cast<const char*>(pixels[i].data()) : reinterpret_cast<const char*>(atlas.Pages[i].Data);
+        file.write(data, pages[i].Size);
+        delete[] atlas.Pages[i].Data;
+    }
+
+    if (!file.good())
+        throw std::runtime_error(std::format("Failed to write baked atlas to '{}'.", output.string()));
+
+    Log(std::format("Baked {} textures into {} pages.\n", textures.size(), pages.size()));
+}
+
+//adds pages of a baked atlas to the image atlas, each page is sent to GPU in a single call straight from the mapped file
+//baked textures are registered under paths they had while being baked (relative ones against the working directory), so 'ResolveTexture' finds them without their files
+//the atlas takes compression & mip levels of the baked one if it hasn't been initialized yet, otherwise they must match
+//new textures are never packed into baked pages, only into areas of unloaded baked textures
+//pages are copied into RAM only if the atlas keeps it's pixels & isn't compressed, otherwise they're uploaded straight from the file
+std::vector<Ogl::TextureHandle> Ogl::LoadBakedAtlas(std::filesystem::path path)
+{
+    if (!std::filesystem::exists(path))
+        throw std::runtime_error(std::format("Invalid baked atlas path: '{}'.", path.string()));
+
+    MappedFile file = MappedFile(path);
+    BakedAtlasHeader header;
+    if (file.Size >= sizeof(BakedAtlasHeader))
+        std::memcpy(&header, file.Data, sizeof(BakedAtlasHeader));
+
+    size_t tablesSize = sizeof(BakedAtlasHeader) + header.PageCount * sizeof(BakedAtlasPage) + header.TextureCount * sizeof(BakedAtlasTexture) + header.PathsSize;
+    if (file.Size < sizeof(BakedAtlasHeader) || std::memcmp(header.Magic, BakedAtlasHeader().Magic, 4) != 0 || header.Version != BAKED_ATLAS_VERSION || file.Size < tablesSize)
+        throw std::runtime_error(std::format("'{}' isn't a valid baked atlas.", path.string()));
+
+    if (Atlas.Name == 0)
+    {
+        Atlas.Compression = header.Compression;
+        Atlas.MipLevels = header.MipLevels;
+        InitializeAtlas(Atlas);
+    }
+    else if (Atlas.Compression != header.Compression || Atlas.MipLevels != header.MipLevels)
+    {
+        throw std::runtime_error(std::format("Baked atlas '{}' has compression {} & {} mip levels, while the atlas has {} & {}.",
+            path.string(), header.Compression, header.MipLevels, Atlas.Compression, Atlas.MipLevels));
+    }
+
+    std::vector<BakedAtlasPage> pages(header.PageCount);
+    std::vector<BakedAtlasTexture> textures(header.TextureCount);
+    const char* data = file.Data + sizeof(BakedAtlasHeader);
+    std::memcpy(pages.data(), data, pages.size() * sizeof(BakedAtlasPage));
+    std::memcpy(textures.data(), data + pages.size() * sizeof(BakedAtlasPage), textures.size() * sizeof(BakedAtlasTexture));
+    const char* texturePaths = data + pages.size() * sizeof(BakedAtlasPage) + textures.size() * sizeof(BakedAtlasTexture);
+
+    //baked pages are full, their packers have no space left
+    unsigned int firstPage = Atlas.Pages.size();
+    for (BakedAtlasPage page : pages)
+    {
+        size_t size = static_cast<size_t>(page.Width) * page.Height * Atlas.Channels;
+        size_t storedSize = Atlas.Compression != 0 ? 0 : size;
+        for (unsigned int level = 0; level < Atlas.MipLevels && Atlas.Compression != 0; level++)
+        {
+            storedSize += static_cast<size_t>(page.Width >> level) * (page.Height >> level) / 16 * GetCompressedBlockSize(Atlas.Compression);
+        }
+
+        if (page.Width % GetAtlasAlignment(Atlas) != 0 || page.Height % GetAtlasAlignment(Atlas) != 0 || page.Width > Atlas.PageSize || page.Height > Atlas.PageSize || page.Size != storedSize || page.Offset > file.Size || page.Size > file.Size - page.Offset)
+            throw std::runtime_error(std::format("'{}' isn't a valid baked atlas.", path.string()));
+
+        RectanglePacker packer = { .Strategy = Atlas.Strategy, .TotalWidth = page.Width, .TotalHeight = page.Height, .MaxWidth = Atlas.PageSize, .MaxHeight = Atlas.PageSize, .IsStarted = true };
+        Atlas.Pages.push_back({ .Packer = packer, .Width = page.Width, .Height = page.Height, .Data = Atlas.KeepPixels ? new unsigned char[size] : NULL });
+
+        if (Atlas.Compression == 0 && Atlas.KeepPixels)
+        {
+            std::memcpy(Atlas.Pages.back().Data, file.Data + page.Offset, size);
+            Atlas.Pages.back().DirtyRects.push_back({ .Width = page.Width, .Height = page.Height });
+        }
+    }
+
+    std::vector<TextureHandle> result;
+    for (BakedAtlasTexture texture : textures)
+    {
+        Rect rect = { texture.X, texture.Y, texture.Width, texture.Height, texture.IsRotated != 0, firstPage + texture.Page };
+        Rect area = GetAtlasArea(Atlas, rect);
+        bool isInside = texture.Page < pages.size() && area.X + static_cast<size_t>(area.Width) <= pages[texture.Page].Width && area.Y + static_cast<size_t>(area.Height) <= pages[texture.Page].Height;
+        bool isInsideImage = texture.OffsetX + static_cast<size_t>(texture.Width) <= texture.SourceWidth && texture.OffsetY + static_cast<size_t>(texture.Height) <= texture.SourceHeight;
+        if (!isInside || !isInsideImage || texture.PathOffset + static_cast<size_t>(texture.PathSize) > header.PathsSize)
+            throw std::runtime_error(std::format("'{}' isn't a valid baked atlas.", path.string()));
+
+        std::string key = std::string(texturePaths + texture.PathOffset, texture.PathSize);
+        AtlasImage image = { rect, texture.OffsetX, texture.OffsetY, texture.SourceWidth, texture.SourceHeight, texture.Hash };
+        result.push_back(AddImageTexture(image, key));
+        TextureRegistry.Add(key, result.back().Index);
+
+        //duplicates take the area once
+        if (GetSharingTextures(result.back().Index).front() == result.back().Index)
+            Atlas.Pages[rect.Page].UsedPixels += static_cast<size_t>(area.Width) * area.Height;
+    }
+
+    UpdateTextureData();
+    UploadAtlas(Atlas);
+
+    if (Atlas.Compression == 0 && !Atlas.KeepPixels)
+    {
+        for (size_t i = 0; i < pages.size(); i++)
+        {
+            const unsigned char* pixels = reinterpret_cast<const unsigned char*>(file.Data + pages[i].Offset);
+            UpdateAtlasRegion(Atlas, firstPage + i, 0, 0, pages[i].Width, pages[i].Height, pixels, pages[i].Width * Atlas.Channels);
+        }
+    }
+
+    if (Atlas.Compression != 0)
+    {
+        glActiveTexture(GL_TEXTURE0 + Atlas.Unit);
+        for (size_t i = 0; i < pages.size(); i++)
+        {
+            size_t offset = pages[i].Offset;
+            for (unsigned int level = 0; level < Atlas.MipLevels; level++)
+            {
+                unsigned int width = pages[i].Width >> level, height = pages[i].Height >> level;
+                size_t size = static_cast<size_t>(width) * height / 16 * GetCompressedBlockSize(Atlas.Compression);
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, firstPage + i, width, height, 1, Atlas.Compression, size, file.Data + offset);
+                offset += size;
+            }
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    //copies of compressed pages are decoded by reading them back, so they hold what's drawn & can be dumped or compacted like the rest
+    if (Atlas.Compression != 0 && Atlas.KeepPixels)
+    {
+        std::vector<unsigned char> texture = ReadAtlasTexture(Atlas);
+        for (size_t i = 0; i < pages.size(); i++)
+        {
+            const unsigned char* layer = texture.data() + static_cast<size_t>(Atlas.TextureWidth) * Atlas.TextureHeight * (firstPage + i) * Atlas.Channels;
+            for (unsigned int row = 0; row < pages[i].Height; row++)
+            {
+                std::memcpy(
+                    Atlas.Pages[firstPage + i].Data + static_cast<size_t>(pages[i].Width) * row * Atlas.Channels,
+                    layer + static_cast<size_t>(Atlas.TextureWidth) * row * Atlas.Channels,
+                    pages[i].Width * Atlas.Channels);
+            }
+        }
+    }
+
+    return result;
 }
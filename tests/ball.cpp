@@ -6,7 +6,7 @@
 
 struct TriangleLayer : Ogl::Layer
 {
-    Ogl::Texture Texture;
+    Ogl::TextureHandle Texture;
 
     TriangleLayer() : Ogl::Layer()
     {
@@ -25,7 +25,7 @@ struct TriangleLayer : Ogl::Layer
 
 struct BallLayer : Ogl::Layer
 {
-    Ogl::Texture Texture;
+    Ogl::TextureHandle Texture;
 
     Color BallColor;
     Vec2 BallPos = Vec2(0.0f);
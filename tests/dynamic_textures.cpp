@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ogl.hpp>
+
+//animates a 1024x1024 scalar field color mapped through a palette & prints the average frame time, argument: 'r16f' to use half floats
+//the whole field is sent to GPU by a single upload per frame & drawn as a single rect
+
+#define FIELD_SIZE 1024
+
+//IEEE half float from a float in [0, 1], values too small for normalized halves are flushed to zero
+unsigned short ToHalf(float value)
+{
+    if (value < 1.0f / 16384.0f)
+        return 0;
+
+    int exponent;
+    float mantissa = std::frexp(value, &exponent); //value = mantissa * 2^exponent, mantissa in [0.5, 1)
+    return static_cast<unsigned short>((exponent + 14) << 10 | static_cast<unsigned int>((mantissa * 2.0f - 1.0f) * 1024.0f));
+}
+
+struct FieldLayer : Ogl::Layer
+{
+    Ogl::TextureHandle Field;
+    bool IsHalf = false;
+    std::vector<unsigned char> Bytes = std::vector<unsigned char>(FIELD_SIZE * FIELD_SIZE);
+    std::vector<unsigned short> Halves = std::vector<unsigned short>(FIELD_SIZE * FIELD_SIZE);
+    size_t Frames = 0;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+    FieldLayer(Ogl::TextureHandle field, bool isHalf) : Ogl::Layer(), Field(field), IsHalf(isHalf) {}
+
+    void Draw() override
+    {
+        //two interfering circular waves
+        float time = Frames * 0.05f;
+        for (int y = 0; y < FIELD_SIZE; y++)
+        {
+            for (int x = 0; x < FIELD_SIZE; x++)
+            {
+                float a = std::hypot(x - FIELD_SIZE * 0.3f, y - FIELD_SIZE * 0.5f), b = std::hypot(x - FIELD_SIZE * 0.7f, y - FIELD_SIZE * 0.5f);
+                float value = 0.5f + 0.25f * (std::sin(a * 0.05f - time) + std::sin(b * 0.05f - time));
+                if (IsHalf)
+                    Halves[y * FIELD_SIZE + x] = ToHalf(value);
+                else
+                    Bytes[y * FIELD_SIZE + x] = static_cast<unsigned char>(value * 255.0f);
+            }
+        }
+
+        Ogl::UpdateDynamicTexture(Field, IsHalf ? static_cast<const void*>(Halves.data()) : Bytes.data());
+        DrawRect(Vec2(-1.0f), Vec2(1.0f), COLOR_TRANSPARENT, Field);
+
+        if (++Frames % 100 == 0)
+        {
+            glFinish();
+            auto now = std::chrono::steady_clock::now();
+            std::cout << std::format("{:.2f} ms per frame\n", std::chrono::duration<double, std::milli>(now - Start).count() / 100.0);
+            Start = now;
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    bool isHalf = argc > 1 && std::string(argv[1]) == "r16f";
+    Ogl::Initialize(800, 800, "Dynamic textures", false);
+
+    //palette going from blue through white to red, it's a dynamic texture as well
+    std::vector<unsigned char> palette;
+    for (int i = 0; i < 256; i++)
+    {
+        unsigned char low = static_cast<unsigned char>(std::min(i * 2, 255)), high = static_cast<unsigned char>(std::min((255 - i) * 2, 255));
+        palette.insert(palette.end(), { low, static_cast<unsigned char>(std::min(low, high)), high, 255 });
+    }
+    Ogl::TextureHandle paletteTexture = Ogl::CreateDynamicTexture(256, 1);
+    Ogl::UpdateDynamicTexture(paletteTexture, palette.data());
+
+    Ogl::TextureHandle field = Ogl::CreateDynamicTexture(FIELD_SIZE, FIELD_SIZE, isHalf ? Ogl::DynamicTextureFormat::R16F : Ogl::DynamicTextureFormat::R8, paletteTexture);
+    FieldLayer layer = FieldLayer(field, isHalf);
+    Ogl::AddLayer(&layer);
+
+    Ogl::UpdateLoop();
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <ogl.hpp>
+
+//measures 'LoadBdfFont' on 'test.bdf' and on the fonts passed as arguments (e.g. unifont)
+//each font is loaded both from source & from it's cache (the first cached load builds the cache)
+
+double MeasureLoading(std::filesystem::path path, unsigned int sdfScale, bool useCache, Ogl::BitmapFont& font)
+{
+    auto start = std::chrono::steady_clock::now();
+    font = Ogl::LoadBdfFont(path, sdfScale, useCache);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    Ogl::Initialize(100, 100, "Font loading", false);
+
+    std::vector<std::filesystem::path> paths = { "test.bdf" };
+    for (int i = 1; i < argc; i++)
+    {
+        paths.push_back(argv[i]);
+    }
+
+    const int iterations = 3;
+    for (std::filesystem::path path : paths)
+    {
+        for (unsigned int sdfScale : { 0, 2 })
+        {
+            for (bool useCache : { false, true })
+            {
+                Ogl::BitmapFont font;
+                double best = std::numeric_limits<double>().max();
+                double total = 0;
+
+                for (int i = 0; i < iterations; i++)
+                {
+                    double time = MeasureLoading(path, sdfScale, useCache, font);
+                    best = std::min(best, time);
+                    total += time;
+                }
+
+                std::cout << std::format("'{}' (sdf scale {}, {}): {} glyphs, best {:.2f} ms, average {:.2f} ms, {:.0f} glyphs/s\n",
+                    path.string(), sdfScale, useCache ? "cached" : "uncached", font.GlyphCount, best, total / iterations, font.GlyphCount / best * 1000.0);
+            }
+        }
+    }
+
+    return 0;
+}
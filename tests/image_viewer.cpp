@@ -2,7 +2,7 @@
 
 struct ImageViewerLayer : Ogl::Layer
 {
-    Ogl::Texture Texture;
+    Ogl::TextureHandle Texture;
 
     ImageViewerLayer() : Ogl::Layer()
     {
@@ -18,9 +18,13 @@ struct ImageViewerLayer : Ogl::Layer
             std::filesystem::path path;
             if (Ogl::OpenFilePicker("Load image", false, path))
             {
+                //previous image is released, so browsing many images doesn't fill up the atlas
+                if (layer->Texture.Index != 0)
+                    Ogl::ReleaseTexture(layer->Texture);
+
                 layer->Texture = Ogl::ResolveTexture(path);
                 Ogl::TextureDimensions textureDimensions = Ogl::TextureDimensionsVector[layer->Texture.Index];
-                Ogl::SetWindowSize(textureDimensions.Width, textureDimensions.Height);
+                Ogl::SetWindowSize(textureDimensions.SourceWidth, textureDimensions.SourceHeight);
             }
         }
     }
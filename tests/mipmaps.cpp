@@ -0,0 +1,55 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <ogl.hpp>
+
+//draws a grid of zoomed out copies of 'test.png' & prints the average frame time, arguments: mip levels of the atlas (1 by default) & camera scale
+//without mip levels each pixel samples a distant texel of the full size image, with them nearby texels of a small level are sampled
+
+struct GridLayer : Ogl::Layer
+{
+    Ogl::TextureHandle Sprite;
+    int Size = 64;
+    size_t Frames = 0;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+    GridLayer(Ogl::TextureHandle sprite) : Ogl::Layer(), Sprite(sprite)
+    {
+        IsWorldSpace = true;
+    }
+
+    void Draw() override
+    {
+        float cell = 1.0f / Size;
+        for (int x = 0; x < Size; x++)
+        {
+            for (int y = 0; y < Size; y++)
+            {
+                Vec2 corner = Vec2(x * cell - 0.5f, y * cell - 0.5f);
+                DrawRect(corner, corner + Vec2(cell), COLOR_TRANSPARENT, Sprite);
+            }
+        }
+
+        if (++Frames % 100 == 0)
+        {
+            glFinish();
+            auto now = std::chrono::steady_clock::now();
+            std::cout << std::format("{:.2f} ms per frame\n", std::chrono::duration<double, std::milli>(now - Start).count() / 100.0);
+            Start = now;
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    Ogl::Atlas.MipLevels = argc > 1 ? std::stoi(argv[1]) : 1;
+    Ogl::Initialize(800, 800, "Mipmaps", false);
+    Ogl::SetCameraScale(argc > 2 ? std::stof(argv[2]) : 1.0f);
+
+    GridLayer layer = GridLayer(Ogl::LoadTextures({ "test.png" })[0]);
+    Ogl::AddLayer(&layer);
+
+    Ogl::UpdateLoop();
+    return 0;
+}
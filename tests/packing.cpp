@@ -0,0 +1,102 @@
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stb_image.h>
+#include <ogl.hpp>
+#include <rectangle_packer.hpp>
+
+//measures 'RectanglePacker' strategies on glyphs of 'test.bdf' & on sprite sets from directories passed as arguments
+//rects are packed into a single page of 'ATLAS_PAGE_SIZE', both sorted all at once & inserted one at a time in their original order
+
+std::vector<Rect> ReadGlyphRects(std::filesystem::path path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error(std::format("Failed to open '{}'.", path.string()));
+
+    std::vector<Rect> rects;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string keyword;
+        unsigned int width, height;
+        if (stream >> keyword && keyword == "BBX" && stream >> width >> height && width != 0 && height != 0)
+            rects.push_back({ .Width = width, .Height = height });
+    }
+
+    return rects;
+}
+
+std::vector<Rect> ReadSpriteRects(std::filesystem::path directory)
+{
+    std::vector<Rect> rects;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory))
+    {
+        int width, height, components;
+        if (entry.is_regular_file() && stbi_info(entry.path().string().c_str(), &width, &height, &components))
+            rects.push_back({ .Width = static_cast<unsigned int>(width), .Height = static_cast<unsigned int>(height) });
+    }
+
+    return rects;
+}
+
+void Measure(std::string name, const std::vector<Rect>& rects, PackingStrategy strategy, bool allowRotation, bool isIncremental)
+{
+    RectanglePacker packer = { .Strategy = strategy, .AllowRotation = allowRotation, .MaxWidth = ATLAS_PAGE_SIZE, .MaxHeight = ATLAS_PAGE_SIZE };
+    size_t unpacked = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    if (isIncremental)
+    {
+        for (Rect rect : rects)
+        {
+            unpacked += packer.Insert(rect) ? 0 : 1;
+        }
+    }
+    else
+    {
+        packer.Rects = rects;
+        unpacked = packer.Pack().size();
+    }
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t usedPixels = 0;
+    for (Rect rect : packer.PackedRects)
+    {
+        usedPixels += static_cast<size_t>(rect.Width) * rect.Height;
+    }
+    double occupancy = packer.TotalWidth * packer.TotalHeight != 0 ? static_cast<double>(usedPixels) / (static_cast<size_t>(packer.TotalWidth) * packer.TotalHeight) : 0.0;
+
+    std::cout << std::format("{:<24} {:<9} {:<8} {:<12} {:>9.2f} ms {:>6.1f}% {:>5}x{:<5} {} unpacked\n",
+        name, strategy == PackingStrategy::Skyline ? "skyline" : "maxrects", allowRotation ? "rotated" : "upright", isIncremental ? "incremental" : "sorted",
+        milliseconds, occupancy * 100.0, packer.TotalWidth, packer.TotalHeight, unpacked);
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::pair<std::string, std::vector<Rect>>> sets = { { "test.bdf", ReadGlyphRects("test.bdf") } };
+    for (int i = 1; i < argc; i++)
+    {
+        sets.push_back({ argv[i], ReadSpriteRects(argv[i]) });
+    }
+
+    for (auto& [name, rects] : sets)
+    {
+        std::cout << std::format("{}: {} rects\n", name, rects.size());
+        for (PackingStrategy strategy : { PackingStrategy::Skyline, PackingStrategy::MaxRects })
+        {
+            for (bool allowRotation : { false, true })
+            {
+                for (bool isIncremental : { false, true })
+                {
+                    Measure(name, rects, strategy, allowRotation, isIncremental);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
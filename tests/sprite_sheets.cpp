@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <ogl.hpp>
+
+//splits 'test.png' into a grid of tiles & draws them shuffled, reshuffling every 60 frames, argument: a JSON sprite sheet whose frames are shown instead
+//tiles are sub-textures of the loaded image, so the image is decoded & stored in atlas only once
+
+#define GRID_SIZE 8
+
+struct TileLayer : Ogl::Layer
+{
+    std::vector<Ogl::TextureHandle> Tiles;
+    std::mt19937 Random;
+    size_t Frames = 0;
+
+    TileLayer(std::vector<Ogl::TextureHandle> tiles) : Ogl::Layer(), Tiles(tiles) {}
+
+    void Draw() override
+    {
+        if (Frames++ % 60 == 0)
+            std::shuffle(Tiles.begin(), Tiles.end(), Random);
+
+        size_t columns = static_cast<size_t>(std::ceil(std::sqrt(Tiles.size())));
+        float cell = 2.0f / columns;
+        for (size_t i = 0; i < Tiles.size(); i++)
+        {
+            Vec2 corner = Vec2(-1.0f + (i % columns) * cell, 1.0f - (i / columns + 1) * cell);
+            DrawRect(corner, corner + Vec2(cell), COLOR_TRANSPARENT, Tiles[i]);
+        }
+    }
+};
+
+int main(int argc, char** argv)
+{
+    Ogl::Initialize(800, 800, "Sprite sheets", false);
+
+    std::vector<Ogl::TextureHandle> tiles;
+    if (argc > 1)
+    {
+        Ogl::SpriteSheet sheet = Ogl::LoadSpriteSheet(argv[1]);
+        tiles = sheet.Frames;
+    }
+    else
+    {
+        Ogl::TextureHandle image = Ogl::LoadTextures({ "test.png" })[0];
+        Ogl::TextureDimensions dimensions = Ogl::TextureDimensionsVector[image.Index];
+        tiles = Ogl::SplitTexture(image, dimensions.SourceWidth / GRID_SIZE, dimensions.SourceHeight / GRID_SIZE);
+    }
+    std::cout << std::format("{} tiles\n", tiles.size());
+
+    TileLayer layer = TileLayer(tiles);
+    Ogl::AddLayer(&layer);
+
+    Ogl::UpdateLoop();
+    return 0;
+}
@@ -6,7 +6,7 @@ const float PixelsPerMeter = 50.0f; //can't define in class
 struct TextLayer : Ogl::Layer
 {
     Ogl::BitmapFont Font;
-    std::string Text = "Use arrows to move the camera.\nScroll to zoom in/out.\nYou can use enter, backspace and paste with ctrl + V.\n:)";
+    Ogl::TextDocument Document;
     std::wstring_convert<std::codecvt_utf8<unsigned int>, unsigned int> Utf32Converter;
 
     TextLayer() : Ogl::Layer()
@@ -15,6 +15,8 @@ struct TextLayer : Ogl::Layer
         Redraw = true;
 
         Font = Ogl::ResolveFont("test.bdf");
+        Document.Font = &Font;
+        Document.SetText("Use arrows to move the camera.\nScroll to zoom in/out.\nYou can use enter, backspace and paste with ctrl + V.\n:)");
 
         Subscribe<Ogl::WindowResizeEvent>(&OnWindowResize);
         Subscribe<Ogl::KeyPressEvent>(&OnKeyPress);
@@ -33,23 +35,29 @@ struct TextLayer : Ogl::Layer
             return;
 
         TextLayer& layer = *reinterpret_cast<TextLayer*>(data);
-        std::string& text = layer.Text;
+        Ogl::TextDocument& document = layer.Document;
         
         if (ev.Key == GLFW_KEY_ENTER)
         {
-            text.push_back('\n');
+            document.Append("\n");
             layer.Redraw = true;
         }
 
         if (ev.Key == GLFW_KEY_V && ev.Modifiers & GLFW_MOD_CONTROL)
         {
-            text.append(Ogl::GetClipboardContents());
+            document.Append(Ogl::GetClipboardContents());
             layer.Redraw = true;
         }
 
-        if (ev.Key == GLFW_KEY_BACKSPACE && text.length() > 0)
+        if (ev.Key == GLFW_KEY_BACKSPACE)
         {
-            text.resize(text.size() - 1);
+            //erasing the last character or the last line end
+            size_t lastLine = document.LineCount - 1;
+            size_t lastLength = document.GetLine(lastLine).Text.size();
+            if (lastLength > 0)
+                document.Erase(lastLine, lastLength - 1, 1);
+            else if (lastLine > 0)
+                document.Erase(lastLine - 1, document.GetLine(lastLine - 1).Text.size(), 1);
             layer.Redraw = true;
         }
     }
@@ -59,7 +67,7 @@ struct TextLayer : Ogl::Layer
         TextLayer& layer = *reinterpret_cast<TextLayer*>(data);
 
         //converting utf32 to utf8
-        layer.Text.append(layer.Utf32Converter.to_bytes(&ev.Codepoint, &ev.Codepoint + 1));
+        layer.Document.Append(layer.Utf32Converter.to_bytes(&ev.Codepoint, &ev.Codepoint + 1));
 
         layer.Redraw = true;
     }
@@ -67,10 +75,13 @@ struct TextLayer : Ogl::Layer
     static void OnScroll(Ogl::ScrollEvent ev, void* data, bool& handled)
     {
         Ogl::SetCameraScale(Ogl::CameraScale + ev.OffsetY * 0.05f);
+        reinterpret_cast<TextLayer*>(data)->Redraw = true;
     }
 
     void Draw() override
     {
+        Vec2 cameraPosition = Ogl::CameraPosition;
+
         if (Ogl::IsKeyPressed(GLFW_KEY_UP))
             Ogl::SetCameraPosition(Ogl::CameraPosition + Vec2(0.0f, 0.05f));
 
@@ -83,8 +94,12 @@ struct TextLayer : Ogl::Layer
         if (Ogl::IsKeyPressed(GLFW_KEY_RIGHT))
             Ogl::SetCameraPosition(Ogl::CameraPosition + Vec2(0.05f, 0.0f));
 
+        //only visible lines are drawn, so moving the camera requires a redraw
+        if (Ogl::CameraPosition != cameraPosition)
+            Redraw = true;
+
         if (Redraw)
-            DrawText(Vec2(0.0f), Text, 1.0f, Font);
+            DrawDocument(Vec2(0.0f), Document, 1.0f);
     }
 };
 
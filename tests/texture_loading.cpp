@@ -0,0 +1,51 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <ogl.hpp>
+
+//measures 'LoadTextures' on the images from the directory passed as an argument (or on copies of 'test.png' if there's none)
+
+int main(int argc, char** argv)
+{
+    Ogl::Initialize(100, 100, "Texture loading", false);
+
+    std::vector<std::filesystem::path> paths;
+    if (argc > 1)
+    {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(argv[1]))
+        {
+            std::string ext = entry.path().extension().string();
+            for (std::string imageExt : IMAGE_EXTS)
+            {
+                if (ext == imageExt)
+                    paths.push_back(entry.path());
+            }
+        }
+    }
+    else
+    {
+        paths.assign(8, "test.png");
+    }
+
+    size_t fileBytes = 0;
+    for (std::filesystem::path path : paths)
+    {
+        fileBytes += std::filesystem::file_size(path);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Ogl::TextureHandle> textures = Ogl::LoadTextures(paths);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t pixelBytes = 0;
+    for (Ogl::TextureHandle texture : textures)
+    {
+        Ogl::TextureDimensions dimensions = Ogl::TextureDimensionsVector[texture.Index];
+        pixelBytes += static_cast<size_t>(dimensions.Width) * dimensions.Height * IMAGE_CHANNELS;
+    }
+
+    std::cout << std::format("{} files in {:.2f} ms: {:.0f} files/s, {:.2f} MB/s read, {:.2f} MB/s decoded\n",
+        paths.size(), seconds * 1000.0, paths.size() / seconds, fileBytes / seconds / 1e6, pixelBytes / seconds / 1e6);
+
+    return 0;
+}
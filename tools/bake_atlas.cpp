@@ -0,0 +1,42 @@
+#include <iostream>
+#include <string>
+#include <ogl.hpp>
+
+//bakes all the images from a directory into a single atlas file, which is loaded with 'Ogl::LoadBakedAtlas'
+//usage: bake_atlas <image directory> <output file> [none|bc1|bc3|bc7]
+//textures are resolved by paths they're found at by this tool, so it should be run from the directory the application is run from
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "Usage: bake_atlas <image directory> <output file> [none|bc1|bc3|bc7]\n";
+        return 1;
+    }
+
+    std::string compressionName = argc == 4 ? argv[3] : "none";
+    unsigned int compression = 0;
+    if (compressionName == "bc1")
+        compression = ATLAS_COMPRESSION_BC1;
+    else if (compressionName == "bc3")
+        compression = ATLAS_COMPRESSION_BC3;
+    else if (compressionName == "bc7")
+        compression = ATLAS_COMPRESSION_BC7;
+    else if (compressionName != "none")
+    {
+        std::cerr << "Unknown compression '" << compressionName << "'.\n";
+        return 1;
+    }
+
+    try
+    {
+        Ogl::BakeAtlas(argv[1], argv[2], compression);
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}